@@ -1,19 +1,27 @@
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/fetch.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/formats.hpp"
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/render.hpp"
+#include "binance_klines/projection.hpp"
+#include "binance_klines/watch.hpp"
+#include "binance_klines/serve.hpp"
+#include "binance_klines/bench.hpp"
+
 #include <iostream>
 #include <string>
 #include <vector>
-#include <iomanip>
 #include <sstream>
 #include <chrono>
-#include <ctime>
-#include <cmath>
-#include <cstdlib> // For getenv
-#include <numeric>
+#include <cstdlib>
 #include <algorithm>
-#include <map>
-
-// For JSON parsing (nlohmann/json)
-#include "json.hpp"
-using json = nlohmann::json;
+#include <climits>
+#include <cctype>
+#include <cstdint>
+#include <future>
 
 // For HTTP requests (libcurl)
 #include <curl/curl.h>
@@ -21,717 +29,490 @@ using json = nlohmann::json;
 // For SQLite
 #include <sqlite3.h>
 
-// --- Global Constants ---
-const std::string BASE_URL = "https://api.binance.us"; // Or https://api.binance.com for global
-const std::string DB_PATH = "binance.db";
-const std::string GEMINI_API_URL = "https://api.gemini.com/v1/pubticker/btcusd";
-
-// --- Global variables from 2-pi-cycle-indicator.cpp ---
-bool g_debug_enabled = false; // Global flag for debug output
-double first_row_yearly_value = 0.00;
-double first_row_baseline     = 0.00;
-double first_row_avg_price    = 0.00;
-double first_row_step         = 0.00;
-
-// --- Helper function for cURL write callback (from both files) ---
-/*----------------------------------------------------------------------------------------------------*/
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
-    size_t newLength = size * nmemb;
-    try {
-        s->append((char*)contents, newLength);
-    } catch (std::bad_alloc &e) {
-        std::cerr << "Memory allocation error in cURL callback: " << e.what() << std::endl;
-        return 0;
-    }
-    return newLength;
-}
-
-// --- Data Structures ---
-
-// From 1-get-binance-klines.cpp
-struct Kline {
-    std::string dt1; // Date string YYYY-MM-DD
-    double price;
-    double open;
-    double high;
-    double low;
-    double close;
-    double volume;
-    int num_trades;
-};
-
-// From 2-pi-cycle-indicator.cpp (renamed from Kline to avoid conflict)
-struct PriceData {
-    std::string date; // YYYY-MM-DD
-    double price;
-};
-
-// From 2-pi-cycle-indicator.cpp
-struct PiCycleData {
-    std::string date;
-    double price;
-    double ma_365       = 0.0; // 365-day Moving Average
-    double std_365      = 0.0; // 365-day Standard Deviation
-    double ceiling      = 0.0; // MA_365 + (2 * STD_365)
-    double floor        = 0.0; // MA_365
-    double median       = 0.0; // (CEILING + FLOOR) / 2
-    double dynamic_step = 0.0; // Dynamic step based on 364-day Price analysis
-    double step         = 0.0; // Same as dynamic_step
-    double change       = 0.0; // Daily price change
-    double move         = 0.0; // Daily price percentage change
-    double offset       = 0.0; // Percentage distance from MEDIAN
-    double weeks_52     = 0.0; // 52-week price percentage change
-};
-
-// From 2-pi-cycle-indicator.cpp
-struct GeminiTicker {
-    double bid;
-    double ask;
-    double last;
-};
-
-
-// --- Functions from 1-get-binance-klines.cpp ---
-
-/*----------------------------------------------------------------------------------------------------*/
-void create_klines_table(sqlite3* db) {
-    char* err_msg = 0;
-    std::string sql = R"(
-        CREATE TABLE IF NOT EXISTS klines (
-            dt1 DATE,
-            price REAL,
-            open REAL,
-            high REAL,
-            low REAL,
-            close REAL,
-            volume REAL,
-            num_trades INTEGER,
-            UNIQUE (dt1)
-        );
-    )";
-    int rc = sqlite3_exec(db, sql.c_str(), 0, 0, &err_msg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error (create_klines_table): " << err_msg << std::endl;
-        sqlite3_free(err_msg);
-    } else {
-        if (g_debug_enabled) {
-            std::cout << "Debug: Table 'klines' checked/created successfully." << std::endl;
-        }
-    }
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-void insert_klines_data(sqlite3* db, const std::vector<Kline>& klines) {
-    std::string sql = R"(
-        INSERT INTO klines (dt1, price, open, high, low, close, volume, num_trades)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-        ON CONFLICT(dt1) DO UPDATE SET
-            price      = excluded.price,
-            open       = excluded.open,
-            high       = excluded.high,
-            low        = excluded.low,
-            close      = excluded.close,
-            volume     = excluded.volume,
-            num_trades = excluded.num_trades;
-    )";
-
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
-        return;
-    }
-
-    sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
-
-    for (const auto& kline : klines) {
-        sqlite3_bind_text(stmt, 1, kline.dt1.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_double(stmt, 2, kline.price);
-        sqlite3_bind_double(stmt, 3, kline.open);
-        sqlite3_bind_double(stmt, 4, kline.high);
-        sqlite3_bind_double(stmt, 5, kline.low);
-        sqlite3_bind_double(stmt, 6, kline.close);
-        sqlite3_bind_double(stmt, 7, kline.volume);
-        sqlite3_bind_int(stmt, 8, kline.num_trades);
-
-        rc = sqlite3_step(stmt);
-        if (rc != SQLITE_DONE) {
-            std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
-        }
-        sqlite3_reset(stmt);
-    }
-    sqlite3_finalize(stmt);
-    sqlite3_exec(db, "END TRANSACTION;", NULL, NULL, NULL);
-    if (g_debug_enabled) {
-        std::cout << "Debug: Klines data inserted/updated successfully." << std::endl;
-    }
-}
-
+// --- Main Function ---
 /*----------------------------------------------------------------------------------------------------*/
-void update_current_date_price_with_close(sqlite3* db) {
-    char* err_msg = 0;
-    std::string sql = R"(
-        UPDATE klines
-        SET price = close
-        WHERE dt1 = (SELECT MAX(dt1) FROM klines);
-    )";
-    int rc = sqlite3_exec(db, sql.c_str(), 0, 0, &err_msg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error (update_current_date_price_with_close): " << err_msg << std::endl;
-        sqlite3_free(err_msg);
-    } else {
-        // Get the date that was updated for logging
-        sqlite3_stmt* stmt;
-        std::string select_max_date_sql = "SELECT MAX(dt1) FROM klines;";
-        rc = sqlite3_prepare_v2(db, select_max_date_sql.c_str(), -1, &stmt, 0);
-        if (rc == SQLITE_OK) {
-            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                const unsigned char* latest_date = sqlite3_column_text(stmt, 0);
-                if (latest_date) {
-                    if (g_debug_enabled) {
-                        std::cout << "Debug: Updated price with close price for latest date: " << latest_date << std::endl;
-                    }
-                } else {
-                    std::cout << "No records found to update in the klines table." << std::endl;
-                }
+int main(int argc, char* argv[]) {
+    OutputSinkScope output; // Buffered std::cout/std::cerr until main returns
+    int num_display_days = 33;
+    int bench_storage_rows = 0;
+    bool bench_load = false;
+    bool force_recompute = false;      // Rebuild every pi_cycle row instead of only the changed ones
+    bool lazy_tail = false;            // Compute the display rows from the klines tail, bypassing pi_cycle
+    std::string columnar_path;         // Read the series from this columnar file instead of SQLite
+    std::string convert_columnar_path; // Append the current binance.db series to this columnar file
+    std::vector<std::string> backfill_list; // Fetch these symbols into their partitions and exit
+    int writer_threads = 4;
+    bool list_partitions = false;
+    bool scan_gaps = false;              // Report missing candles in every partition and exit
+    bool fill_gaps = false;              // ... after fetching the missing ranges
+    int bench_ingest_symbols = 0;
+    std::string compressed_path;         // Read the series from this compressed block file instead of SQLite
+    std::string convert_compressed_path; // Write the current partition to this compressed block file
+    bool bench_compression = false;
+    int bench_window_rows = 0;
+    std::string arrow_path;              // Export klines + pi_cycle to this Arrow IPC file and exit
+    size_t arrow_batch_rows = 65536;
+    std::string query_from, query_to;    // Show the stored rows of these days (YYYY-MM-DD) and exit
+    bool print_output_stats = false;     // Report the output syscall counters at exit
+    std::string output_format;           // csv, json or ndjson: export the series instead of the table
+    double watch_seconds = 0.0;          // Keep the newest row live, polling at this interval
+    bool live_quotes = true;             // Overlay the exchanges' current quotes on the newest row
+    double quote_ttl = QUOTE_TTL_SECONDS;
+    size_t mc_paths = 0;                 // Monte Carlo bands instead of the step projection
+    MonteCarloModel mc_model = MC_BOOTSTRAP;
+    std::string mc_targets = "+30d,ye,+365d"; // Monte Carlo target dates
+    std::string horizon_spec = DEFAULT_HORIZONS; // Rows of the projection table
+    bool project_all = false;            // Project every partition of --interval and exit
+    uint64_t mc_seed = 1;
+    int walk_forward_days = 0;           // Score past projections against the price this many days later
+    std::string serve_address;           // Port on 127.0.0.1 or Unix socket path for the band server
+    int bench_serve_requests = 0;
+    int bench_output_lines = 0;
+    int bench_export_rows = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--debug") {
+            g_debug_enabled = true;
+        } else if (arg == "--bench-storage") {
+            bench_storage_rows = 100000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_storage_rows = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--recompute") {
+            force_recompute = true;
+        } else if (arg == "--lazy") {
+            lazy_tail = true;
+        } else if (arg == "--bench-load") {
+            bench_load = true;
+        } else if (arg == "--columnar" && i + 1 < argc) {
+            columnar_path = argv[++i];
+        } else if (arg == "--convert-columnar" && i + 1 < argc) {
+            convert_columnar_path = argv[++i];
+        } else if (arg == "--symbol" && i + 1 < argc) {
+            g_symbol = argv[++i];
+            std::transform(g_symbol.begin(), g_symbol.end(), g_symbol.begin(), ::toupper);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            g_interval = argv[++i];
+        } else if (arg == "--backfill" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string symbol;
+            while (std::getline(list, symbol, ',')) {
+                std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+                if (!symbol.empty()) backfill_list.push_back(symbol);
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            writer_threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--compressed" && i + 1 < argc) {
+            compressed_path = argv[++i];
+        } else if (arg == "--convert-compressed" && i + 1 < argc) {
+            convert_compressed_path = argv[++i];
+        } else if (arg == "--bench-compression") {
+            bench_compression = true;
+        } else if (arg == "--bench-window") {
+            bench_window_rows = 100000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_window_rows = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--export-arrow" && i + 1 < argc) {
+            arrow_path = argv[++i];
+        } else if (arg == "--batch-rows" && i + 1 < argc) {
+            arrow_batch_rows = (size_t)std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--date" && i + 1 < argc) {
+            query_from = query_to = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            query_from = argv[++i];
+        } else if (arg == "--to" && i + 1 < argc) {
+            query_to = argv[++i];
+        } else if (arg.compare(0, 9, "--format=") == 0) {
+            output_format = arg.substr(9);
+        } else if (arg == "--format" && i + 1 < argc) {
+            output_format = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_address = argv[++i];
+        } else if (arg == "--bench-serve") {
+            bench_serve_requests = 200000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_serve_requests = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--watch") {
+            watch_seconds = 1.0;
+            if (i + 1 < argc && (std::isdigit(static_cast<unsigned char>(argv[i + 1][0])) || argv[i + 1][0] == '.')) {
+                watch_seconds = std::max(0.1, std::atof(argv[++i]));
+            }
+        } else if (arg == "--monte-carlo") {
+            mc_paths = MC_DEFAULT_PATHS;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                mc_paths = (size_t)std::max(1LL, std::atoll(argv[++i]));
+            }
+        } else if (arg == "--mc-model" && i + 1 < argc) {
+            std::string model = argv[++i];
+            if (model == "gbm") {
+                mc_model = MC_GBM;
+            } else if (model == "bootstrap") {
+                mc_model = MC_BOOTSTRAP;
+            } else {
+                std::cerr << "Error: --mc-model must be bootstrap or gbm, not '" << model << "'." << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mc-targets" && i + 1 < argc) {
+            mc_targets = argv[++i];
+        } else if (arg == "--horizons" && i + 1 < argc) {
+            horizon_spec = argv[++i];
+        } else if (arg == "--project-all") {
+            project_all = true;
+        } else if (arg == "--mc-seed" && i + 1 < argc) {
+            mc_seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--walk-forward") {
+            walk_forward_days = PROJECTION_STEP_ROWS;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                walk_forward_days = std::max(1, std::atoi(argv[++i]));
+            }
+        } else if (arg == "--no-quotes") {
+            live_quotes = false;
+        } else if (arg == "--quote-ttl" && i + 1 < argc) {
+            quote_ttl = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--stats") {
+            print_output_stats = true;
+        } else if (arg == "--bench-output") {
+            bench_output_lines = 100000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_output_lines = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--bench-export") {
+            bench_export_rows = 1000000;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_export_rows = std::atoi(argv[++i]);
+            }
+        } else if (arg == "--gaps") {
+            scan_gaps = true;
+        } else if (arg == "--fill-gaps") {
+            scan_gaps = fill_gaps = true;
+        } else if (arg == "--partitions") {
+            list_partitions = true;
+        } else if (arg == "--bench-ingest") {
+            bench_ingest_symbols = 16;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                bench_ingest_symbols = std::atoi(argv[++i]);
             }
-        }
-        sqlite3_finalize(stmt);
-    }
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-std::vector<Kline> get_klines_from_binance() {
-    std::vector<Kline> klines_data;
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
-
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (curl) {
-        std::string url = BASE_URL + "/api/v3/klines?symbol=BTCUSDT&interval=1d&limit=500";
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L); // WARNING: For testing, disable in production
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L); // WARNING: For testing, disable in production
-
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
         } else {
             try {
-                json klines_json = json::parse(readBuffer);
-                if (klines_json.is_array()) {
-                    for (const auto& kline_array : klines_json) {
-                        Kline kline;
-                        // Convert timestamp (ms) to date string (YYYY-MM-DD)
-                        long long open_time_ms = kline_array[0].get<long long>();
-                        std::chrono::system_clock::time_point open_time_tp = std::chrono::system_clock::from_time_t(open_time_ms / 1000);
-                        std::time_t open_time_t = std::chrono::system_clock::to_time_t(open_time_tp);
-                        std::tm* ptm = std::gmtime(&open_time_t); // Use gmtime for UTC
-                        std::stringstream ss;
-                        ss << std::put_time(ptm, "%Y-%m-%d");
-                        kline.dt1 = ss.str();
-
-                        kline.open = std::stod(kline_array[1].get<std::string>());
-                        kline.high = std::stod(kline_array[2].get<std::string>());
-                        kline.low = std::stod(kline_array[3].get<std::string>());
-                        kline.close = std::stod(kline_array[4].get<std::string>());
-                        kline.volume = std::stod(kline_array[5].get<std::string>());
-                        kline.num_trades = kline_array[8].get<int>();
-
-                        // Calculate price as (high + low) / 2, rounded to 2 decimals
-                        kline.price = std::round(((kline.high + kline.low) / 2.0) * 100.0) / 100.0;
-
-                        klines_data.push_back(kline);
-                    }
-                    if (g_debug_enabled) {
-                        std::cout << "Debug: Fetched " << klines_data.size() << " klines from Binance." << std::endl;
-                    }
-                } else if (klines_json.is_object() && klines_json.contains("msg")) {
-                    std::cerr << "Binance API Error: " << klines_json["msg"].get<std::string>() << std::endl;
-                } else {
-                    std::cerr << "Unexpected JSON response from Binance API." << std::endl;
-                }
-            } catch (const json::parse_error& e) {
-                std::cerr << "JSON parse error: " << e.what() << std::endl;
-                std::cerr << "Received data: " << readBuffer.substr(0, std::min((int)readBuffer.length(), 500)) << "..." << std::endl; // Print first 500 chars
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing klines data: " << e.what() << std::endl;
+                num_display_days = std::stoi(arg);
+                if (num_display_days < 33) num_display_days = 33;
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Invalid argument for num_display_days: " << arg << std::endl;
+            } catch (const std::out_of_range& e) {
+                std::cerr << "num_display_days out of range: " << arg << std::endl;
             }
         }
-        curl_easy_cleanup(curl);
     }
-    curl_global_cleanup();
-    return klines_data;
-}
-
-// --- Functions from 2-pi-cycle-indicator.cpp ---
-
-/*----------------------------------------------------------------------------------------------------*/
-std::vector<PriceData> fetch_data() {
-    std::vector<PriceData> klines_data;
-    sqlite3* db;
-    int rc = sqlite3_open(DB_PATH.c_str(), &db);
 
-    if (rc) {
-        std::cerr << "Error: Can't open database: " << sqlite3_errmsg(db) << std::endl;
-        return klines_data;
-    } else {
-        if (g_debug_enabled) {
-            std::cout << "Debug: Database opened successfully." << std::endl;
-        }
+    if (print_output_stats) output.report_stats_at_exit();
+    if (!valid_symbol(g_symbol) || !valid_interval(g_interval)) {
+        std::cerr << "Error: --symbol takes A-Z/0-9 and --interval 1s through 1M: " << g_symbol << " " << g_interval << std::endl;
+        return 1;
     }
-
-    std::string query = "SELECT dt1 AS Date, price AS Price FROM klines ORDER BY Date ASC;";
-    sqlite3_stmt* stmt;
-
-    rc = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-        if (g_debug_enabled) {
-            std::cerr << "Debug: Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+    const EpochDay today = current_epoch_day();
+    std::vector<ProjectionHorizon> horizons; // Rows of the projection table
+    if (!parse_horizons(horizon_spec, today, horizons) || horizons.empty()) {
+        std::cerr << "Error: --horizons needs +N/+Nd/+Nw offsets, future YYYY-MM-DD dates, qe or ye: " << horizon_spec << std::endl;
+        return 1;
+    }
+    std::vector<ProjectionHorizon> mc_horizons; // --monte-carlo targets, ascending
+    if (mc_paths > 0) {
+        if (!parse_horizons(mc_targets, today, mc_horizons) || mc_horizons.empty()) {
+            std::cerr << "Error: --mc-targets needs +N/+Nd/+Nw offsets, future YYYY-MM-DD dates, qe or ye: " << mc_targets << std::endl;
+            return 1;
         }
-        sqlite3_close(db);
-        return klines_data;
-    } else {
-        if (g_debug_enabled) {
-            std::cout << "Debug: SQL statement prepared successfully." << std::endl;
+        std::stable_sort(mc_horizons.begin(), mc_horizons.end(),
+                         [](const ProjectionHorizon& a, const ProjectionHorizon& b) { return a.days < b.days; });
+        mc_horizons.erase(std::unique(mc_horizons.begin(), mc_horizons.end(),
+                                      [](const ProjectionHorizon& a, const ProjectionHorizon& b) { return a.days == b.days; }),
+                          mc_horizons.end());
+        if (interval_ms(g_interval) <= 0) {
+            std::cerr << "Error: --monte-carlo needs a fixed-length interval, not " << g_interval << "." << std::endl;
+            return 1;
         }
     }
-
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        PriceData kline; // Changed from Kline
-        kline.date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        kline.price = sqlite3_column_double(stmt, 1);
-        klines_data.push_back(kline);
+    if (bench_output_lines > 0) {
+        run_output_benchmark(bench_output_lines);
+        return 0;
     }
-
-    if (rc != SQLITE_DONE) {
-        std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
+    if (bench_export_rows > 0) {
+        run_export_benchmark(bench_export_rows);
+        return 0;
     }
-
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    if (g_debug_enabled) {
-        std::cout << "Debug: Fetched " << klines_data.size() << " klines from database." << std::endl;
+    if (bench_storage_rows > 0) {
+        run_storage_benchmark(bench_storage_rows);
+        return 0;
     }
-    return klines_data;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-double calculate_average_daily_increase(int days) {
-    sqlite3* db;
-    int rc = sqlite3_open(DB_PATH.c_str(), &db);
-
-    if (rc) {
-        std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
-        return 0.0;
+    if (bench_ingest_symbols > 0) {
+        run_ingest_benchmark(bench_ingest_symbols, 5000);
+        return 0;
     }
-
-    std::string query = "";
-    // SQLite doesn't have INTERVAL, so we need to use date function
-    query = "SELECT ROUND(AVG(daily_increase), 4) AS avg_daily_increase FROM ( SELECT dt1, (price - LAG(price) OVER (ORDER BY dt1)) AS daily_increase FROM klines WHERE dt1 >= date('now', '-' || ? || ' days') ) AS price_changes WHERE daily_increase IS NOT NULL;";
-
-    sqlite3_stmt* stmt;
-    rc = sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_close(db);
-        return 0.0;
+    if (bench_window_rows > 0) {
+        run_window_benchmark(bench_window_rows);
+        return 0;
     }
 
-    sqlite3_bind_int(stmt, 1, days);
-
-    double avg_daily_increase = 0.0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        avg_daily_increase = sqlite3_column_double(stmt, 0);
+    KlineCatalog catalog;
+    if (!catalog.open(CATALOG_PATH)) {
+        return 1;
     }
+    g_db_path = catalog.partition_path(g_symbol, g_interval);
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return avg_daily_increase;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-GeminiTicker gemini_get_bid_ask_last() {
-    GeminiTicker ticker = {0.0, 0.0, 0.0};
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
-
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    if (curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, GEMINI_API_URL.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L); // WARNING: For testing, disable in production
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L); // WARNING: For testing, disable in production
-
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        } else {
-            try {
-                json data = json::parse(readBuffer);
-                ticker.bid = std::stod(data["bid"].get<std::string>());
-                ticker.ask = std::stod(data["ask"].get<std::string>());
-                ticker.last = std::stod(data["last"].get<std::string>());
-            } catch (const json::parse_error& e) {
-                std::cerr << "JSON parse error: " << e.what() << std::endl;
-                std::cerr << "Received data: " << readBuffer.substr(0, std::min((int)readBuffer.length(), 500)) << "..." << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing Gemini ticker data: " << e.what() << std::endl;
-            }
-        }
-        curl_easy_cleanup(curl);
+    if (list_partitions) {
+        print_partitions(catalog);
+        return 0;
     }
-    curl_global_cleanup();
-    return ticker;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-std::vector<PiCycleData> price_projection(const std::vector<PriceData>& klines, double yearly_multiplier) {
-    std::vector<PiCycleData> pi_data(klines.size());
-
-    for (size_t i = 0; i < klines.size(); ++i) {
-        pi_data[i].date = klines[i].date;
-        pi_data[i].price = klines[i].price;
-
-        if (i >= 364) { // Need 365 data points for 365-day MA and STD
-            double sum_price = 0.0;
-            for (size_t j = i - 364; j <= i; ++j) {
-                sum_price += klines[j].price;
-            }
-            pi_data[i].ma_365 = sum_price / 365.0;
-
-            double sum_sq_diff = 0.0;
-            for (size_t j = i - 364; j <= i; ++j) {
-                sum_sq_diff += std::pow(klines[j].price - pi_data[i].ma_365, 2);
-            }
-            pi_data[i].std_365 = std::sqrt(sum_sq_diff / 365.0);
-
-            pi_data[i].ceiling = pi_data[i].ma_365 + (2 * pi_data[i].std_365);
-            pi_data[i].floor = pi_data[i].ma_365;
-            pi_data[i].median = (pi_data[i].ceiling + pi_data[i].floor) / 2.0;
-        }
+    if (project_all) {
+        run_projection_grid(catalog, g_interval, horizons, writer_threads);
+        return 0;
     }
-    return pi_data;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-std::vector<PiCycleData> add_calculated_fields(std::vector<PiCycleData> pi_data, int num_display_days) {
-    // Calculate daily price changes
-    for (size_t i = 1; i < pi_data.size(); ++i) {
-        pi_data[i].change = pi_data[i].price - pi_data[i-1].price;
-        if (pi_data[i-1].price != 0) {
-            pi_data[i].move = (pi_data[i].price - pi_data[i-1].price) / pi_data[i-1].price * 100.0;
-        }
+    if (walk_forward_days > 0) {
+        run_walk_forward(catalog, g_interval, walk_forward_days, writer_threads);
+        return 0;
     }
-
-    // Calculate dynamic step (simplified: rolling average of daily changes)
-    const int lookback_days_for_step = 364; // Corresponds to 364-day lookback in Python
-    for (size_t i = 0; i < pi_data.size(); ++i) {
-        if (i >= lookback_days_for_step) {
-            double sum_daily_diff = 0.0;
-            for (int j = 0; j < lookback_days_for_step; ++j) {
-                sum_daily_diff += pi_data[i - j].change; // Summing up daily changes
-            }
-            pi_data[i].dynamic_step = sum_daily_diff / lookback_days_for_step;
-        }
-        pi_data[i].step = pi_data[i].dynamic_step;
+    if (!serve_address.empty()) {
+        return run_band_server(catalog, serve_address);
     }
-
-    // Calculate Offset - distance from MEDIAN as percentage
-    for (size_t i = 0; i < pi_data.size(); ++i) {
-        if (pi_data[i].median != 0) {
-            pi_data[i].offset = ((pi_data[i].price - pi_data[i].median) / pi_data[i].median) * 100.0;
-        }
+    if (bench_serve_requests > 0) {
+        run_serve_benchmark(catalog, bench_serve_requests, writer_threads);
+        return 0;
     }
-
-    // Calculate actual 364-day price percentage change (current price vs price 364 days ago)
-    for (size_t i = 0; i < pi_data.size(); ++i) {
-        if (i >= 364) {
-            if (pi_data[i - 364].price != 0) {
-                pi_data[i].weeks_52 = ((pi_data[i].price - pi_data[i - 364].price) / pi_data[i - 364].price) * 100.0;
-            }
-        }
+    if (bench_load) {
+        run_load_benchmark(20);
+        return 0;
     }
-
-    return pi_data;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-std::string format_numeric(double value, const std::string& format_spec) {
-    if (std::isnan(value)) return "";
-    std::stringstream ss;
-    if (format_spec.find("f") != std::string::npos) { // Floating point
-        int precision = std::stoi(format_spec.substr(format_spec.find(".") + 1, format_spec.find("f") - format_spec.find(".") - 1));
-        ss << std::fixed << std::setprecision(precision);
-    } else { // Integer or general
-        ss << std::fixed << std::setprecision(0);
-    }
-    ss << value;
-    std::string s = ss.str();
-    // Add commas for thousands (simple implementation for integer part)
-    size_t decimal_point_pos = s.find('.');
-    std::string integer_part = (decimal_point_pos == std::string::npos) ? s : s.substr(0, decimal_point_pos);
-    std::string fractional_part = (decimal_point_pos == std::string::npos) ? "" : s.substr(decimal_point_pos);
-
-    int insertPosition = integer_part.length() - 3;
-    while (insertPosition > 0 && integer_part[insertPosition-1] != '-') {
-        integer_part.insert(insertPosition, ",");
-        insertPosition -= 3;
+    if (!convert_columnar_path.empty()) {
+        return convert_db_to_columnar(g_db_path, convert_columnar_path) ? 0 : 1;
     }
-    return integer_part + fractional_part;
-};
-
-/*----------------------------------------------------------------------------------------------------*/
-void display_public(const std::vector<PiCycleData>& pi_data_reversed) {
-    // Constants for color codes
-    const std::string COLOR_BRIGHT_GREEN = "\033[92m";
-    const std::string COLOR_GREEN        = "\033[32m";
-    const std::string COLOR_DARK_GREEN   = "\033[38;5;22m";
-    const std::string COLOR_YELLOW_GREEN = "\033[38;5;142m";
-    const std::string COLOR_YELLOW       = "\033[93m";
-    const std::string COLOR_YELLOW_RED   = "\033[38;5;208m";
-    const std::string COLOR_DARK_RED     = "\033[38;5;52m";
-    const std::string COLOR_RED          = "\033[91m";
-    const std::string COLOR_BRIGHT_RED   = "\033[38;5;196m";
-    const std::string COLOR_RESET        = "\033[0m";
-
-    // Column definitions with their formatting specifications
-    static const std::map<std::string, std::map<std::string, std::string>> COLUMN_FORMATS = {
-        {"Date",     {{"width", "10"}, {"align", "<"}, {"prefix", " "}}},
-        {"Price",    {{"width", "9"}, {"align", ">"}, {"prefix", ""}}},
-        {"Move",     {{"width", "7"},  {"align", ">"}, {"prefix", " "}}},
-        {"Offset",   {{"width", "7"},  {"align", ">"}, {"prefix", ""}}},
-        {"CEILING",  {{"width", "9"}, {"align", ">"}, {"prefix", ""}}},
-        {" MEDIAN",  {{"width", "9"}, {"align", ">"}, {"prefix", ""}}},
-        {" FLOOR ",  {{"width", "9"}, {"align", ">"}, {"prefix", ""}}},
-        {"Step",     {{"width", "5"},  {"align", ">"}, {"prefix", ""}}},
-        {"Change",   {{"width", "7"},  {"align", ">"}, {"prefix", ""}}},
-        {"52-weeks", {{"width", "9"},  {"align", "^"}, {"prefix", " "}}}
-    };
-
-    // Print header
-    std::cout << "+------------+----------+--------+--------+----------+----------+----------+------+--------+----------+" << std::endl;
-    std::cout << "|    Date    |   Price  |  Move  | Offset | CEILING  |  MEDIAN  |  FLOOR   | Step | Change | 52-weeks |" << std::endl;
-    std::cout << "+------------+----------+--------+--------+----------+----------+----------+------+--------+----------+" << std::endl;
-
-    // Extract first row values for global variables
-    if (!pi_data_reversed.empty()) {
-        const auto& first_row  = pi_data_reversed[0];
-        first_row_yearly_value = first_row.weeks_52;
-        first_row_baseline     = first_row.median;
-        first_row_step         = first_row.step;
-        first_row_avg_price    = first_row.price;
+    if (!convert_compressed_path.empty()) {
+        return convert_db_to_compressed(g_db_path, convert_compressed_path) ? 0 : 1;
+    }
+    if (bench_compression) {
+        run_compression_benchmark();
+        return 0;
+    }
+    if (!arrow_path.empty()) {
+        KlineStore store;
+        if (!store.open(g_db_path) || refresh_pi_cycle(store.db(), force_recompute) < 0) {
+            return 1;
+        }
+        long long exported = export_arrow(store.db(), arrow_path, arrow_batch_rows);
+        if (exported < 0) return 1;
+        std::cout << "Exported " << exported << " " << g_symbol << " " << g_interval << " rows to " << arrow_path << "." << std::endl;
+        return 0;
     }
 
-    for (const auto& row : pi_data_reversed) {
-        std::string row_color = COLOR_RESET; // Default to reset
-
-        // Determine color based on price position
-        double median_threshold = row.median * 0.02;
-        if (std::abs(row.price - row.median) <= median_threshold) {
-            if (row.price > row.median) row_color = COLOR_YELLOW_GREEN;
-            else if (row.price < row.median) row_color = COLOR_YELLOW_RED;
-            else row_color = COLOR_YELLOW;
-        } else if (row.price >= row.median) {
-            double range_above = row.ceiling - row.median;
-            double percentage_above = (range_above > 0) ? (row.price - row.median) / range_above : 0.0;
-            if (percentage_above >= 0.575) row_color = COLOR_BRIGHT_GREEN;
-            else if (percentage_above >= 0.29) row_color = COLOR_GREEN;
-            else row_color = COLOR_DARK_GREEN;
+    if (!output_format.empty() || !query_from.empty() || !query_to.empty()) {
+        // Open-ended sides reach the ends of any series
+        EpochDay from = INT32_MIN, to = INT32_MAX;
+        if ((!query_from.empty() && !parse_ymd(query_from, from)) || (!query_to.empty() && !parse_ymd(query_to, to))) {
+            std::cerr << "Error: Dates must be YYYY-MM-DD: " << query_from << " " << query_to << std::endl;
+            return 1;
+        }
+        SeriesFormat format = SERIES_CSV;
+        if (!output_format.empty() && !parse_series_format(output_format, format)) {
+            std::cerr << "Error: --format must be csv, json or ndjson, not '" << output_format << "'." << std::endl;
+            return 1;
+        }
+        SeriesWriter writer(format);
+        ColumnarFile columnar_file;
+        ColumnarSeries mapped;
+        KlineColumns loaded;
+        PriceSeriesView series;
+        if (!columnar_path.empty()) {
+            if (!columnar_file.open(columnar_path) || !columnar_file.find(g_symbol, g_interval, mapped)) {
+                std::cerr << "No " << g_symbol << " " << g_interval << " series in " << columnar_path << ". Exiting." << std::endl;
+                return 1;
+            }
+            series = price_series_view(mapped);
+        } else if (!compressed_path.empty()) {
+            if (!load_compressed_series(compressed_path, loaded)) return 1;
+            series = price_series_view(loaded);
         } else {
-            double range_below = row.median - row.floor;
-            double percentage_below = (range_below > 0) ? (row.median - row.price) / range_below : 0.0;
-            if (percentage_below >= 0.575) row_color = COLOR_BRIGHT_RED;
-            else if (percentage_below >= 0.29) row_color = COLOR_RED;
-            else row_color = COLOR_DARK_RED;
+            KlineStore store;
+            if (!store.open(g_db_path)) return 1;
+            if (!output_format.empty()) {
+                // Stream the materialized rows instead of loading the series
+                return refresh_pi_cycle(store.db(), force_recompute) >= 0
+                       && export_pi_cycle(store.db(), epoch_day_to_ms(from), epoch_day_to_ms(to) + MS_PER_DAY - 1, writer) >= 0 ? 0 : 1;
+            }
+            loaded = load_kline_columns(store.db(), KLINE_OPEN_TIME | KLINE_PRICE);
+            series = price_series_view(loaded);
         }
-
-        std::stringstream ss_row;
-        ss_row << "|";
-
-        // Date
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Date").at("width"))) << std::left << (COLUMN_FORMATS.at("Date").at("prefix") + row.date) << " |";
-
-        // Price
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Price").at("width"))) << std::right << format_numeric(row.price, "0f") << " |";
-
-        // Move
-        std::stringstream ss_move;
-        ss_move << std::fixed << std::setprecision(2) << row.move << "%";
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Move").at("width"))) << std::right << (COLUMN_FORMATS.at("Move").at("prefix") + ss_move.str()) << " |";
-
-        // Offset
-        std::stringstream ss_offset;
-        ss_offset << std::fixed << std::setprecision(1) << row.offset << "%";
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Offset").at("width"))) << std::right << (COLUMN_FORMATS.at("Offset").at("prefix") + ss_offset.str()) << " |";
-
-        // CEILING
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("CEILING").at("width"))) << std::right << format_numeric(row.ceiling, "0f") << " |";
-
-        // MEDIAN
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at(" MEDIAN").at("width"))) << std::right << format_numeric(row.median, "0f") << " |";
-
-        // FLOOR
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at(" FLOOR ").at("width"))) << std::right << format_numeric(row.floor, "0f") << " |";
-
-        // Step
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Step").at("width"))) << std::right << format_numeric(row.step, "0f") << " |";
-
-        // Change
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("Change").at("width"))) << std::right << format_numeric(row.change, "0f") << " |";
-
-        // 52-weeks
-        std::stringstream ss_52weeks;
-        ss_52weeks << std::fixed << std::setprecision(2) << row.weeks_52 << "%";
-        ss_row << std::setw(std::stoi(COLUMN_FORMATS.at("52-weeks").at("width"))) << std::right << (COLUMN_FORMATS.at("52-weeks").at("prefix") + ss_52weeks.str()) << " |";
-
-        std::cout << row_color << ss_row.str() << COLOR_RESET << std::endl;
+        if (!output_format.empty()) {
+            return export_series(series, from, to, writer) >= 0 ? 0 : 1;
+        }
+        return run_date_query(series, from, to) ? 0 : 1;
     }
-    std::cout << "+------------+----------+--------+--------+----------+----------+----------+------+--------+----------+" << std::endl;
-}
-
-/*----------------------------------------------------------------------------------------------------*/
-void prediction_target_step(const std::vector<PiCycleData>& pi_data_reversed) {
-    const int RANGE = 30;
-    double sum_top_steps = 0.0;
-    int count_top_steps = 0;
 
-    // Get the last RANGE step values
-    for (int i = 0; i < RANGE && i < pi_data_reversed.size(); ++i) {
-        sum_top_steps += pi_data_reversed[i].step;
-        count_top_steps++;
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    if (!backfill_list.empty()) {
+        backfill_symbols(catalog, backfill_list, g_interval, writer_threads);
+        curl_global_cleanup();
+        return 0;
+    }
+    if (scan_gaps) {
+        report_kline_gaps(catalog, fill_gaps, writer_threads);
+        curl_global_cleanup();
+        return 0;
     }
 
-    double average_top_steps = (count_top_steps > 0) ? sum_top_steps / count_top_steps : 0.0;
-
-    std::cout << std::fixed << std::setprecision(2);
-    std::cout << "| " << RANGE << "-day Avg Step: " << average_top_steps << " (Dynamic 364-day Price-based)" << std::endl;
-
-    // Get current date
-    auto now          = std::chrono::system_clock::now();
-    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-    std::tm* ptm_now  = std::localtime(&now_c);
-
-    // Calculate days until end of 2025
-    std::tm end_2025_tm    = *ptm_now;    // Copy current time info
-    end_2025_tm.tm_year    = 2025 - 1900; // Year is 1900-based
-    end_2025_tm.tm_mon     = 11;          // Month is 0-based (December)
-    end_2025_tm.tm_mday    = 31;          // Day of month
-    std::time_t end_2025_t = std::mktime(&end_2025_tm);
-    
-    long long days_until_2025 = (end_2025_t - now_c) / (60 * 60 * 24);
-
-    // Predictions
-    double predicted_price_2025 = first_row_baseline + (average_top_steps * days_until_2025);
-    double predicted_price_4w   = first_row_baseline + (average_top_steps * RANGE);
-
-    // Calculate dates for predictions
-    auto date_4w = now + std::chrono::hours(24 * RANGE);
-    std::time_t date_4w_c = std::chrono::system_clock::to_time_t(date_4w);
-    std::tm* ptm_4w = std::localtime(&date_4w_c);
-
-    std::cout << "+------------+------------+-------------------------------+" << std::endl;
-    std::cout << "|    2025    | " << std::setw(2) << std::right << "$" << format_numeric(predicted_price_2025, "0f") << "  | "
-              << std::put_time(&end_2025_tm, "%B %d, %Y") << std::endl;
-    std::cout << "|    +4w     | " << std::setw(2) << std::right << "$" << format_numeric(predicted_price_4w, "0f") << "  | "
-              << std::put_time(ptm_4w, "%B %d, %Y") << std::endl;
-    std::cout << "+------------+------------+-------------------------------+" << std::endl;
-}
-
-// --- Main Function ---
-/*----------------------------------------------------------------------------------------------------*/
-int main(int argc, char* argv[]) {
     // --- Part 1: Get Binance Klines ---
-    sqlite3* db = nullptr;
-    int rc = sqlite3_open(DB_PATH.c_str(), &db);
-
-    if (rc) {
-        std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
+    if (!update_catalog_partition(catalog, g_symbol, g_interval)) {
+        curl_global_cleanup();
         return 1;
-    } else {
-        if (g_debug_enabled) {
-            std::cout << "Debug: Opened database successfully." << std::endl;
-        }
-    }
-
-    create_klines_table(db);
-
-    std::vector<Kline> klines_from_api = get_klines_from_binance();
-    if (!klines_from_api.empty()) {
-        insert_klines_data(db, klines_from_api);
-        update_current_date_price_with_close(db);
-    } else {
-        std::cerr << "No klines data fetched. Skipping database operations." << std::endl;
     }
-
-    sqlite3_close(db);
     if (g_debug_enabled) {
         std::cout << "\nDebug: --- Kline data update complete ---\n" << std::endl;
     }
-
+    if (watch_seconds > 0) {
+        int status = run_watch(num_display_days, watch_seconds, live_quotes, quote_ttl);
+        curl_global_cleanup();
+        return status;
+    }
 
     // --- Part 2: Pi Cycle Indicator ---
+    // Clear screen (platform-dependent) with ANSI escapes, as 2-pi-cycle-indicator does; skipped with
+    // --debug so Part 1's debug output stays visible
+    if (!g_debug_enabled) {
     #ifdef _WIN32
         system("cls");
     #else
-        // system("clear"); // Commented out to see the output from part 1
+        std::cout << "\033[H\033[2J" << std::flush;
     #endif
+    }
 
-    int num_display_days = 33;
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        if (arg == "--debug") {
-            g_debug_enabled = true;
+    std::vector<PiCycleData> pi_data_reversed;
+    double avg_daily_increase = 0.0;
+    const int TREND_DAYS = PROJECTION_TREND_DAYS;
+
+    // The quotes are fetched while the indicator rows are computed
+    LiveQuoteFeed quote_feed(g_symbol, quote_ttl);
+    std::future<std::vector<VenueQuote>> quote_fetch;
+    if (live_quotes) {
+        quote_fetch = std::async(std::launch::async, [&quote_feed]() { return quote_feed.quotes(); });
+    }
+    auto fail = [&quote_fetch]() {
+        if (quote_fetch.valid()) quote_fetch.wait(); // Before curl_global_cleanup()
+        curl_global_cleanup();
+        return 1;
+    };
+    LivePiCycle live; // Window of the newest row, for the live overlay
+    int price_decimals = 2;
+    std::vector<double> mc_returns; // Log returns of the trend window, for --monte-carlo
+
+    if (!columnar_path.empty() || !compressed_path.empty()) {
+        // Mapped columnar or decoded block series: indicators are computed in memory
+        ColumnarFile columnar_file;
+        ColumnarSeries mapped;
+        KlineColumns decoded;
+        PriceSeriesView series;
+        if (!columnar_path.empty()) {
+            if (!columnar_file.open(columnar_path) || !columnar_file.find(g_symbol, g_interval, mapped)) {
+                std::cerr << "No " << g_symbol << " " << g_interval << " series in " << columnar_path << ". Exiting." << std::endl;
+                return fail();
+            }
+            series = price_series_view(mapped);
         } else {
-            try {
-                num_display_days = std::stoi(arg);
-                if (num_display_days < 33) num_display_days = 33;
-            } catch (const std::invalid_argument& e) {
-                std::cerr << "Invalid argument for num_display_days: " << arg << std::endl;
-            } catch (const std::out_of_range& e) {
-                std::cerr << "num_display_days out of range: " << arg << std::endl;
+            if (!load_compressed_series(compressed_path, decoded)) {
+                return fail();
             }
+            series = price_series_view(decoded);
         }
-    }
 
-    double avg_daily_increase = calculate_average_daily_increase(365 * 4 + 1);
+        if (g_debug_enabled) {
+            std::cout << "Debug: Loaded " << series.size << " klines." << std::endl;
+        }
 
-    std::vector<PriceData> klines_from_db = fetch_data();
+        // Long-run trend from the series already in memory (previously a separate LAG() query)
+        DailyChangeAggregates daily_changes(series);
+        avg_daily_increase = daily_changes.average_change_days(TREND_DAYS);
+
+        pi_data_reversed = compute_display_rows(series, num_display_days);
+        live.reset(series);
+        if (mc_paths > 0) mc_returns = log_returns_since(series, trailing_days_cutoff_ms(TREND_DAYS));
+    } else if (lazy_tail) {
+        // Read-only: only the display rows plus their lookback are loaded and computed
+        KlineStore store;
+        if (!store.open(g_db_path)) {
+            return fail();
+        }
+        KlineColumns tail = load_price_tail(store.db(), num_display_days + PI_CYCLE_LOOKBACK_ROWS);
+        if (g_debug_enabled) {
+            std::cout << "Debug: Loaded " << tail.size << " tail klines." << std::endl;
+        }
+        pi_data_reversed = compute_display_rows(price_series_view(tail), num_display_days);
+        live.reset(price_series_view(tail));
+        price_decimals = stored_price_decimals(store.db());
+
+        KlineColumns trend_window = load_price_window(store.db(), trailing_days_cutoff_ms(TREND_DAYS), 0);
+        DailyChangeAggregates daily_changes(price_series_view(trend_window));
+        avg_daily_increase = daily_changes.average_change_days(TREND_DAYS);
+        if (mc_paths > 0) mc_returns = log_returns_since(price_series_view(trend_window), 0);
+    } else {
+        // binance.db: bring the materialized pi_cycle rows up to date, then read the display rows back
+        KlineStore store;
+        if (!store.open(g_db_path)) {
+            return fail();
+        }
+        sqlite3* db = store.db();
+        if (refresh_pi_cycle(db, force_recompute) < 0) {
+            std::cerr << "Error: Failed to refresh the pi_cycle table." << std::endl;
+        }
+        pi_data_reversed = load_pi_cycle_latest(db, num_display_days);
+        live.reset(price_series_view(load_price_tail(db, PI_CYCLE_LOOKBACK_ROWS + 1)));
+        price_decimals = stored_price_decimals(db);
+
+        // Long-run trend over just the rows in its window
+        KlineColumns trend_window = load_price_window(db, trailing_days_cutoff_ms(TREND_DAYS), 0);
+        DailyChangeAggregates daily_changes(price_series_view(trend_window));
+        avg_daily_increase = daily_changes.average_change_days(TREND_DAYS);
+        if (mc_paths > 0) mc_returns = log_returns_since(price_series_view(trend_window), 0);
+    }
+
+    std::vector<VenueQuote> quotes;
+    MergedQuote merged;
+    if (quote_fetch.valid()) {
+        quotes = quote_fetch.get();
+        merged = merge_quotes(quotes);
+        if (merged.price > 0 && !overlay_live_row(live, merged.price, pi_data_reversed) && g_debug_enabled) {
+            std::cout << "Debug: Stored klines end before the previous period; live quotes not overlaid." << std::endl;
+        }
+    }
 
-    if (klines_from_db.empty()) {
+    if (pi_data_reversed.empty()) {
         std::cerr << "No klines data fetched from DB. Exiting." << std::endl;
-        return 1;
+        return fail();
     }
 
-    if (g_debug_enabled) {
-        std::cout << "Debug: Fetched " << klines_from_db.size() << " klines." << std::endl;
+    display_public(pi_data_reversed);
+    if (live_quotes) {
+        print_live_quotes(quotes, merged, price_decimals);
     }
 
-    std::vector<PiCycleData> pi_data = price_projection(klines_from_db, (avg_daily_increase / 100.0) + 1);
-    pi_data = add_calculated_fields(pi_data, num_display_days);
+    if (mc_paths > 0) {
+        // Monte Carlo bands replace the straight-line projection
+        const long long step_ms = interval_ms(g_interval);
+        std::vector<int> horizon_steps;
+        for (const auto& horizon : mc_horizons) {
+            horizon_steps.push_back((int)std::max(1LL, horizon.days * MS_PER_DAY / step_ms));
+        }
 
-    // Filter for last num_display_days and reverse for display
-    std::vector<PiCycleData> pi_data_reversed;
-    if (pi_data.size() > num_display_days) {
-        pi_data_reversed.assign(pi_data.end() - num_display_days, pi_data.end());
+        const auto mc_start = std::chrono::steady_clock::now();
+        std::vector<MonteCarloBand> bands = simulate_price_bands(mc_returns, mc_model, pi_data_reversed[0].price,
+                                                                 horizon_steps, mc_paths, writer_threads, mc_seed);
+        const double mc_ms = elapsed_ms(mc_start);
+        if (bands.empty()) {
+            std::cerr << "Error: Not enough " << g_symbol << " history for a Monte Carlo projection." << std::endl;
+            return fail();
+        }
+        print_monte_carlo(bands, mc_horizons, mc_model, mc_paths, mc_returns.size(), mc_ms, writer_threads);
     } else {
-        pi_data_reversed = pi_data;
+        prediction_target_step(pi_data_reversed, avg_daily_increase, horizons);
     }
-    std::reverse(pi_data_reversed.begin(), pi_data_reversed.end());
-
-    display_public(pi_data_reversed);
-
-    GeminiTicker ticker = gemini_get_bid_ask_last();
-    // std::cout << "Gemini Ticker: Bid=" << ticker.bid << ", Ask=" << ticker.ask << ", Last=" << ticker.last << std::endl;
-
-    prediction_target_step(pi_data_reversed);
 
+    curl_global_cleanup();
     return 0;
 }
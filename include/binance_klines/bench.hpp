@@ -0,0 +1,41 @@
+// Benchmarks behind the --bench-* flags
+#ifndef BINANCE_KLINES_BENCH_HPP
+#define BINANCE_KLINES_BENCH_HPP
+
+// --- Benchmarks ---
+
+// Compares the legacy text-keyed table against the current WITHOUT ROWID layout on a scratch
+// database: a cold upsert of every row, a warm upsert where every row conflicts, and an ordered
+// full scan.
+void run_storage_benchmark(int rows);
+
+// Time to get the full price series into memory from binance.db through fetch_data() versus mapping
+// the same series from a columnar file. Each iteration includes opening the source and touching
+// every price so neither side gets away with lazy loading.
+void run_load_benchmark(int iterations);
+
+// Ingest rate versus writer threads: `symbols` synthetic symbols of `rows` candles each are upserted
+// into their own scratch partitions, once per thread count. Every partition has its own write lock,
+// so the rate should scale until the disk or fsync cost becomes the bottleneck.
+void run_ingest_benchmark(int symbols, int rows);
+
+// The Pi Cycle bands over a synthetic daily series in an in-memory KlineStore, three ways: the native
+// window functions, the same bands spelled with SQLite's built-in AVG() windows (mean of x and of x^2),
+// and price_projection() as the reference the other two are checked against.
+void run_window_benchmark(int rows);
+
+// Compression ratio and encode/decode throughput of the block format on the current partition
+// (--symbol/--interval; BTCUSDT 1m is the intended input), or on a synthetic minute series if the
+// partition holds less than one full block.
+void run_compression_benchmark();
+
+// Writes `lines` log lines ending in std::endl to /dev/null through a line-flushed sink (what a
+// plain std::cout does when redirected and flushed per line) and through buffered sinks, counting the
+// syscalls each one makes.
+void run_output_benchmark(int lines);
+
+// --format export throughput: `rows` indicator rows through SeriesWriter to /dev/null in each format,
+// plus a per-field snprintf("%.17g") exporter for comparison.
+void run_export_benchmark(int rows);
+
+#endif // BINANCE_KLINES_BENCH_HPP
@@ -0,0 +1,257 @@
+// Shared types, constants and globals: klines, Pi Cycle rows, dates as days since the epoch
+#ifndef BINANCE_KLINES_COMMON_HPP
+#define BINANCE_KLINES_COMMON_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+// --- Global Constants ---
+
+extern const std::string BASE_URL; // Or https://api.binance.com for global
+extern const std::string DB_PATH;
+extern const std::string GEMINI_API_URL; // + pair, e.g. btcusd
+extern const std::string CATALOG_PATH; // (symbol, interval) -> partition database
+extern const std::string PARTITION_DIR; // Default home of partitions other than binance.db
+
+// --- Global Variables ---
+
+extern bool g_debug_enabled; // Global flag for debug output
+extern std::string g_symbol;
+extern std::string g_interval;
+extern std::string g_db_path; // Partition of g_symbol/g_interval, resolved through the catalog
+extern double first_row_yearly_value;
+extern double first_row_avg_price;
+extern double first_row_step;
+
+// --- Data Structures ---
+
+// Fixed-point price: an integer number of ticks of 10^-price_decimals (see kline_scale)
+typedef long long PriceTicks;
+
+struct Kline {
+    long long open_time; // Open time (ms since epoch, UTC)
+    PriceTicks price;
+    PriceTicks open;
+    PriceTicks high;
+    PriceTicks low;
+    PriceTicks close;
+    double volume;
+    int num_trades;
+    long long close_time;          // Close time (ms since epoch, UTC)
+    double quote_volume;           // Quote asset volume
+    double taker_buy_base_volume;  // Taker buy base asset volume
+    double taker_buy_quote_volume; // Taker buy quote asset volume
+};
+
+// Outcome of a change-detecting upsert
+struct UpsertStats {
+    int inserted = 0;
+    int updated  = 0;
+    int skipped  = 0; // Identical to the stored row; not written
+};
+
+// Column selection mask for load_kline_columns()
+enum KlineColumn : unsigned {
+    KLINE_OPEN_TIME              = 1u << 0,
+    KLINE_PRICE                  = 1u << 1,
+    KLINE_OPEN                   = 1u << 2,
+    KLINE_HIGH                   = 1u << 3,
+    KLINE_LOW                    = 1u << 4,
+    KLINE_CLOSE                  = 1u << 5,
+    KLINE_VOLUME                 = 1u << 6,
+    KLINE_NUM_TRADES             = 1u << 7,
+    KLINE_CLOSE_TIME             = 1u << 8,
+    KLINE_QUOTE_VOLUME           = 1u << 9,
+    KLINE_TAKER_BUY_BASE_VOLUME  = 1u << 10,
+    KLINE_TAKER_BUY_QUOTE_VOLUME = 1u << 11,
+    KLINE_ALL_COLUMNS            = (1u << 12) - 1
+};
+
+// Column-oriented klines; only the vectors selected by `columns` are populated
+struct KlineColumns {
+    unsigned columns = 0;
+    size_t size      = 0;
+    std::vector<long long> open_time;
+    std::vector<double>    price;
+    std::vector<double>    open;
+    std::vector<double>    high;
+    std::vector<double>    low;
+    std::vector<double>    close;
+    std::vector<double>    volume;
+    std::vector<int>       num_trades;
+    std::vector<long long> close_time;
+    std::vector<double>    quote_volume;
+    std::vector<double>    taker_buy_base_volume;
+    std::vector<double>    taker_buy_quote_volume;
+};
+
+// Read-only view of an ordered price series, backed by KlineColumns vectors or a mapped columnar file
+struct PriceSeriesView {
+    const long long* open_time = nullptr; // ms since epoch, UTC
+    const double*    price     = nullptr;
+    size_t           size      = 0;
+};
+
+struct PiCycleData {
+    long long open_time = 0; // ms since epoch, UTC
+    double price;
+    double ma_365       = 0.0; // 365-day Moving Average
+    double std_365      = 0.0; // 365-day Standard Deviation
+    double ceiling      = 0.0; // MA_365 + (2 * STD_365)
+    double floor        = 0.0; // MA_365
+    double median       = 0.0; // (CEILING + FLOOR) / 2
+    double dynamic_step = 0.0; // Dynamic step based on 364-day Price analysis
+    double step         = 0.0; // Same as dynamic_step
+    double change       = 0.0; // Daily price change
+    double move         = 0.0; // Daily price percentage change
+    double offset       = 0.0; // Percentage distance from MEDIAN
+    double weeks_52     = 0.0; // 52-week price percentage change
+};
+
+// Bid, ask and last trade of one venue
+struct Ticker {
+    double bid;
+    double ask;
+    double last;
+};
+
+// --- Date Utilities ---
+//
+// UTC calendar arithmetic on integer epoch days (days since 1970-01-01), after Howard Hinnant's
+// days_from_civil/civil_from_days. Pure integer math: no time_t, no gmtime/localtime, no locale and
+// no allocation, so it is safe to call from any thread.
+
+typedef int32_t EpochDay;
+
+const long long MS_PER_DAY       = 86400000LL;
+const size_t    DATE_BUFFER_SIZE = 11; // "YYYY-MM-DD" + NUL
+
+const char* const MONTH_NAMES[12] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December"
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+inline EpochDay days_from_civil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);                       // [0, 399]
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1; // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;           // [0, 146096]
+    return era * 146097 + (int)doe - 719468;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+inline void civil_from_days(EpochDay z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);                             // [0, 146096]
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;    // [0, 399]
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                  // [0, 365]
+    const unsigned mp = (5 * doy + 2) / 153;                                       // [0, 11], March = 0
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)yoe + era * 400 + (m <= 2);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Floor division, so instants before 1970 land on the right day too
+inline EpochDay epoch_day(long long time_ms) {
+    return (EpochDay)((time_ms >= 0 ? time_ms : time_ms - (MS_PER_DAY - 1)) / MS_PER_DAY);
+}
+
+inline long long epoch_day_to_ms(EpochDay day) { return (long long)day * MS_PER_DAY; }
+
+/*----------------------------------------------------------------------------------------------------*/
+inline EpochDay current_epoch_day() {
+    return epoch_day(std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+inline void write_two_digits(char* out, unsigned value) {
+    static const char DIGIT_PAIRS[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+    std::memcpy(out, DIGIT_PAIRS + 2 * value, 2);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Writes "YYYY-MM-DD" and a terminating NUL into `out` (at least DATE_BUFFER_SIZE bytes) and returns
+// it. Years are written modulo 10000.
+inline char* format_ymd(EpochDay day, char* out) {
+    int y;
+    unsigned m, d;
+    civil_from_days(day, y, m, d);
+    const unsigned year = (unsigned)y % 10000;
+    write_two_digits(out, year / 100);
+    write_two_digits(out + 2, year % 100);
+    out[4] = '-';
+    write_two_digits(out + 5, m);
+    out[7] = '-';
+    write_two_digits(out + 8, d);
+    out[10] = '\0';
+    return out;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// "December 31, 2025" into `out` (at least 20 bytes); returns the length written
+inline size_t format_long_date(EpochDay day, char* out) {
+    int y;
+    unsigned m, d;
+    civil_from_days(day, y, m, d);
+    const char* month = MONTH_NAMES[m - 1];
+    size_t length = std::strlen(month);
+    std::memcpy(out, month, length);
+    out[length++] = ' ';
+    write_two_digits(out + length, d);
+    length += 2;
+    out[length++] = ',';
+    out[length++] = ' ';
+    const unsigned year = (unsigned)y % 10000;
+    write_two_digits(out + length, year / 100);
+    write_two_digits(out + length + 2, year % 100);
+    length += 4;
+    out[length] = '\0';
+    return length;
+}
+
+std::string format_date(long long open_time_ms);
+
+// Start of the UTC day `days` days before today, in ms since epoch (SQLite's date('now', '-N days'))
+long long trailing_days_cutoff_ms(int days);
+
+// --- Intervals ---
+
+// Open time of the candle in progress now; weekly candles open on Monday, four days after the epoch
+long long current_open_time(long long step_ms);
+
+// --- Timing ---
+
+double elapsed_ms(std::chrono::steady_clock::time_point start);
+
+// --- Parallel Jobs ---
+
+/*----------------------------------------------------------------------------------------------------*/
+// Runs job(i) for every i in [0, count) on up to `threads` workers that pull indices from a shared
+// counter, so a slow symbol never holds back the others.
+template <typename Job>
+void run_parallel(size_t count, int threads, Job job) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            job(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads && (size_t)t < count; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) thread.join();
+}
+
+#endif // BINANCE_KLINES_COMMON_HPP
@@ -0,0 +1,184 @@
+// Binance and Gemini REST clients over libcurl: klines, tick sizes, gap filling and live quotes
+#ifndef BINANCE_KLINES_FETCH_HPP
+#define BINANCE_KLINES_FETCH_HPP
+
+#include "binance_klines/common.hpp"
+#include "binance_klines/store.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+// For HTTP requests (libcurl)
+#include <curl/curl.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Binance REST API ---
+
+// The partition's price decimals, asking the exchange and recording the answer the first time.
+// Returns -1 when no scale is recorded and the exchange could not be reached.
+int ensure_price_decimals(sqlite3* db, const std::string& symbol);
+
+// curl_global_init() is not thread-safe, so main() calls it once before any fetch runs. Without a
+// start_time the exchange returns the latest `limit` candles; end_time (inclusive) is optional.
+// Prices are parsed into ticks of 10^-price_decimals; a price off that grid fails the whole batch
+// and sets `*off_grid`, so the caller can rescale the partition and retry.
+std::vector<Kline> get_klines_from_binance(const std::string& symbol, const std::string& interval, int price_decimals,
+                                           long long start_time = 0, long long end_time = 0, int limit = 500,
+                                           CURL* session = nullptr, bool* off_grid = nullptr);
+
+// --- Partition Updates ---
+
+// Upserts the latest candles of `symbol` into the partition at `db_path` and returns how many were
+// fetched. A failed fetch is reported and leaves the partition as it was (0); -1 means the partition
+// cannot be opened. When the exchange's tick got finer than the recorded scale, the partition is
+// rescaled first.
+long long update_partition(const std::string& db_path, const std::string& symbol, const std::string& interval);
+
+// update_partition() for the catalogued partition of symbol/interval. A pair is registered only once
+// a fetch has filled it, so a mistyped symbol leaves no catalog entry or file behind. Returns false
+// for invalid names and when there is no partition to read afterwards.
+bool update_catalog_partition(KlineCatalog& catalog, const std::string& symbol, const std::string& interval);
+
+// Fetches and upserts each symbol into its own partition, one writer per thread. Invalid symbols are
+// skipped, and partitions are registered after their first successful fetch.
+void backfill_symbols(KlineCatalog& catalog, const std::vector<std::string>& symbols, const std::string& interval, int threads);
+
+// --- Gemini Ticker ---
+
+// Bid, ask and last trade of a Gemini pair ("btcusd"); all zero on failure
+Ticker gemini_get_bid_ask_last(const std::string& pair, CURL* session = nullptr);
+
+// --- Gap Filling ---
+
+// Scans every catalogued partition for gaps and prints a report. With `fill`, the missing ranges
+// are fetched first (partitions in parallel) and the report shows what was recovered and what is
+// still missing afterwards.
+void report_kline_gaps(KlineCatalog& catalog, bool fill, int threads);
+
+// --- Live Quotes ---
+//
+// Between runs the newest stored candle is only as fresh as the last fetch. The live-quote overlay
+// asks each exchange that lists the symbol for bid/ask/last. Binance's last trade becomes the newest
+// display row's price, since its candles are the ones stored, and only that row is recomputed through
+// the rolling window of LivePiCycle. The other venues (Gemini) only show the cross-exchange spread
+// and the best bid and ask. Each venue's answer is
+// kept for a short TTL, so a refresh inside it does not pay another TLS round trip. The venues are
+// asked in parallel, each over its own kept-alive connection.
+
+const double QUOTE_TTL_SECONDS = 5.0; // Default --quote-ttl
+const size_t QUOTE_BINANCE     = 0;   // Binance, whose candles the table is built from, is always venue 0
+
+struct VenueQuote {
+    const char* venue;
+    Ticker      ticker; // All zero when the venue could not be reached
+};
+
+struct MergedQuote {
+    int         venues     = 0;       // Venues with a last price
+    double      price      = 0.0;     // Binance's last price; 0 when Binance did not answer
+    double      best_bid   = 0.0;
+    double      best_ask   = 0.0;
+    const char* bid_venue  = nullptr;
+    const char* ask_venue  = nullptr;
+    double      spread     = 0.0;     // Highest minus lowest last price
+    double      spread_pct = 0.0;     // ... as a percentage of `price`
+};
+
+// Bid, ask and last trade of a Binance symbol from its 24-hour ticker; all zero on failure
+Ticker binance_get_bid_ask_last(const std::string& symbol, CURL* session = nullptr);
+
+// Gemini pair of a USD-quoted Binance symbol ("BTCUSDT" -> "btcusd"), or "" when there is none.
+// Stablecoin quotes map to the USD pair, so the spread includes the stablecoin's own premium.
+std::string gemini_pair(const std::string& symbol);
+
+/*----------------------------------------------------------------------------------------------------*/
+// Quotes of one symbol from every venue that lists it, each cached for `ttl_seconds`
+class LiveQuoteFeed {
+public:
+    LiveQuoteFeed(const std::string& symbol, double ttl_seconds)
+        : ttl_(std::chrono::duration<double>(std::max(0.0, ttl_seconds))), fetches_(0), hits_(0) {
+        add("Binance", symbol, binance_get_bid_ask_last);
+        const std::string pair = gemini_pair(symbol);
+        if (!pair.empty()) add("Gemini", pair, gemini_get_bid_ask_last);
+    }
+
+    ~LiveQuoteFeed() {
+        for (auto& venue : venues_) {
+            if (venue.session) curl_easy_cleanup(venue.session);
+        }
+    }
+
+    LiveQuoteFeed(const LiveQuoteFeed&) = delete;
+    LiveQuoteFeed& operator=(const LiveQuoteFeed&) = delete;
+
+    // Current quote of every venue, in venue order. Venues whose last answer is younger than the TTL
+    // are not asked again; the others are asked in parallel.
+    std::vector<VenueQuote> quotes() {
+        const auto now = std::chrono::steady_clock::now();
+        std::vector<size_t> stale;
+        for (size_t i = 0; i < venues_.size(); ++i) {
+            if (!venues_[i].fetched || now - venues_[i].fetched_at >= ttl_) stale.push_back(i);
+        }
+        run_parallel(stale.size(), (int)stale.size(), [&](size_t k) {
+            Venue& venue = venues_[stale[k]];
+            if (!venue.session) venue.session = curl_easy_init();
+            if (venue.session) venue.quote.ticker = venue.fetch(venue.id, venue.session);
+            venue.fetched_at = now; // Failures are kept too, so a dead venue is retried once per TTL
+            venue.fetched = true;
+        });
+        fetches_ += stale.size();
+        hits_ += venues_.size() - stale.size();
+
+        std::vector<VenueQuote> result;
+        result.reserve(venues_.size());
+        for (const auto& venue : venues_) result.push_back(venue.quote);
+        if (g_debug_enabled) {
+            std::cout << "Debug: Quotes from " << stale.size() << " venues, " << venues_.size() - stale.size()
+                      << " from the cache." << std::endl;
+        }
+        return result;
+    }
+
+    unsigned long long fetches() const { return fetches_; }
+    unsigned long long hits() const { return hits_; }
+
+private:
+    typedef Ticker (*Fetch)(const std::string&, CURL*);
+
+    struct Venue {
+        VenueQuote  quote;
+        std::string id;    // Symbol or pair in the venue's own naming
+        Fetch       fetch;
+        CURL*       session;
+        bool        fetched;
+        std::chrono::steady_clock::time_point fetched_at;
+    };
+
+    void add(const char* name, const std::string& id, Fetch fetch) {
+        Venue venue;
+        venue.quote.venue = name;
+        venue.quote.ticker = {0.0, 0.0, 0.0};
+        venue.id = id;
+        venue.fetch = fetch;
+        venue.session = nullptr;
+        venue.fetched = false;
+        venues_.push_back(venue);
+    }
+
+    std::chrono::duration<double> ttl_;
+    std::vector<Venue>            venues_;
+    unsigned long long            fetches_;
+    unsigned long long            hits_;
+};
+
+// Binance's last trade as the newest row's price, plus the best bid and ask across venues and the
+// spread between their last prices. Gemini's USD price is not mixed into a USDT candle; without a
+// Binance last `price` stays 0.
+MergedQuote merge_quotes(const std::vector<VenueQuote>& quotes);
+
+#endif // BINANCE_KLINES_FETCH_HPP
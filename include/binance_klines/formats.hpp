@@ -0,0 +1,221 @@
+// File formats beside SQLite: the columnar file, the compressed block format and Arrow IPC export
+#ifndef BINANCE_KLINES_FORMATS_HPP
+#define BINANCE_KLINES_FORMATS_HPP
+
+#include "binance_klines/common.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+// For the memory-mapped columnar backend (POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Columnar File Backend ---
+//
+// Append-only binary file of fixed-width columns that is read through mmap, so the indicator engine
+// works directly on the mapped arrays without any per-row parsing. Layout (native little-endian):
+//
+//   [header   ] COLUMNAR_HEADER_SIZE bytes: magic, format version, header size
+//   [segment  ] one per append: int64 open_time[n], then double price/open/high/low/close/volume[n],
+//               each column starting on an 8-byte boundary
+//   [footer   ] uint64 entry count + one ColumnarFooterEntry per symbol/interval
+//   [trailer  ] uint64 footer offset + COLUMNAR_TRAILER_MAGIC
+//
+// Appending a segment writes the new column data and a fresh footer + trailer after the current end
+// of file; the previous footer is left in place as dead space and the last trailer always wins. A
+// symbol/interval that is appended again points at its newest segment.
+
+const char     COLUMNAR_MAGIC[8]         = {'B', 'K', 'C', 'O', 'L', 'S', '0', '1'};
+const char     COLUMNAR_TRAILER_MAGIC[8] = {'B', 'K', 'C', 'F', 'O', 'O', 'T', '1'};
+const uint32_t COLUMNAR_HEADER_SIZE      = 64;
+const int      COLUMNAR_COLUMN_COUNT     = 7; // open_time, price, open, high, low, close, volume
+
+struct ColumnarFooterEntry {
+    char     symbol[16];
+    char     interval[8];
+    uint64_t row_count;
+    int64_t  first_open_time;
+    int64_t  last_open_time;
+    uint64_t column_offsets[COLUMNAR_COLUMN_COUNT];
+};
+
+// Zero-copy view of one symbol/interval inside a mapped columnar file
+struct ColumnarSeries {
+    size_t         size      = 0;
+    const long long* open_time = nullptr;
+    const double*  price     = nullptr;
+    const double*  open      = nullptr;
+    const double*  high      = nullptr;
+    const double*  low       = nullptr;
+    const double*  close     = nullptr;
+    const double*  volume    = nullptr;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+class ColumnarFile {
+public:
+    ColumnarFile() {}
+    ~ColumnarFile() { close(); }
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Can't open columnar file " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)(COLUMNAR_HEADER_SIZE + 2 * sizeof(uint64_t))) {
+            std::cerr << "Error: Columnar file " << path << " is truncated." << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            std::cerr << "Error: mmap failed for " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data_ = static_cast<const char*>(base);
+        size_ = (size_t)st.st_size;
+
+        if (std::memcmp(data_, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0
+            || std::memcmp(data_ + size_ - sizeof(COLUMNAR_TRAILER_MAGIC), COLUMNAR_TRAILER_MAGIC, sizeof(COLUMNAR_TRAILER_MAGIC)) != 0) {
+            std::cerr << "Error: " << path << " is not a columnar kline file." << std::endl;
+            close();
+            return false;
+        }
+        // Bounds are checked by subtraction and division, so a corrupt offset or count cannot wrap
+        // around, and the entries must be 8-byte aligned to be read in place
+        const size_t footer_end = size_ - 2 * sizeof(uint64_t); // Start of the trailer
+        uint64_t footer_offset;
+        std::memcpy(&footer_offset, data_ + footer_end, sizeof(footer_offset));
+        uint64_t entry_count = 0;
+        bool valid = footer_offset % 8 == 0 && footer_offset <= footer_end - sizeof(uint64_t);
+        if (valid) {
+            std::memcpy(&entry_count, data_ + footer_offset, sizeof(entry_count));
+            valid = entry_count <= (footer_end - footer_offset - sizeof(uint64_t)) / sizeof(ColumnarFooterEntry);
+        }
+        if (!valid) {
+            std::cerr << "Error: Columnar file " << path << " has a corrupt footer." << std::endl;
+            close();
+            return false;
+        }
+        entries_ = reinterpret_cast<const ColumnarFooterEntry*>(data_ + footer_offset + sizeof(uint64_t));
+        entry_count_ = (size_t)entry_count;
+        return true;
+    }
+
+    void close() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        entries_ = nullptr;
+        entry_count_ = 0;
+    }
+
+    std::vector<ColumnarFooterEntry> entries() const {
+        return std::vector<ColumnarFooterEntry>(entries_, entries_ + entry_count_);
+    }
+
+    bool find(const std::string& symbol, const std::string& interval, ColumnarSeries& series) const {
+        for (size_t i = 0; i < entry_count_; ++i) {
+            const ColumnarFooterEntry& entry = entries_[i];
+            if (symbol == std::string(entry.symbol, strnlen(entry.symbol, sizeof(entry.symbol)))
+                && interval == std::string(entry.interval, strnlen(entry.interval, sizeof(entry.interval)))) {
+                for (int c = 0; c < COLUMNAR_COLUMN_COUNT; ++c) {
+                    const uint64_t offset = entry.column_offsets[c];
+                    if (offset % 8 != 0 || offset > size_ || entry.row_count > (size_ - offset) / 8) return false;
+                }
+                series.size      = (size_t)entry.row_count;
+                series.open_time = reinterpret_cast<const long long*>(data_ + entry.column_offsets[0]);
+                series.price     = reinterpret_cast<const double*>(data_ + entry.column_offsets[1]);
+                series.open      = reinterpret_cast<const double*>(data_ + entry.column_offsets[2]);
+                series.high      = reinterpret_cast<const double*>(data_ + entry.column_offsets[3]);
+                series.low       = reinterpret_cast<const double*>(data_ + entry.column_offsets[4]);
+                series.close     = reinterpret_cast<const double*>(data_ + entry.column_offsets[5]);
+                series.volume    = reinterpret_cast<const double*>(data_ + entry.column_offsets[6]);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const char*                data_        = nullptr;
+    size_t                     size_        = 0;
+    const ColumnarFooterEntry* entries_     = nullptr;
+    size_t                     entry_count_ = 0;
+};
+
+bool convert_db_to_columnar(const std::string& db_path, const std::string& out_path);
+
+// --- Compressed Block Format ---
+//
+// Long minute-level histories are stored as independent blocks of up to COMPRESSED_BLOCK_ROWS rows.
+// Each block is [uint32 byte length][uint32 rows][bit stream], the bit stream holding, in order:
+//
+//   open_time  first value in 64 bits, then Gorilla delta-of-delta codes: '0' for an unchanged
+//              spacing, '10'/'110'/'1110'/'11110' + 7/9/12/32-bit zigzag value, '11111' + 64 bits
+//   price, open, high, low, close, volume
+//              a 1-bit encoding tag per column. Fixed-point delta (tag 0): 4-bit decimal count d,
+//              7-bit width w, the first value * 10^d in 64 bits and every following zigzag delta in
+//              w bits. Gorilla XOR (tag 1): for columns where no d <= 8 round-trips every value
+//              exactly, the first value's bits in 64 bits and then the usual XOR control codes.
+//
+// Decoding is exact: a column only uses fixed point when (double)q / 10^d reproduces every input
+// bit for bit. Blocks decode independently, so the indicator engine can stream through a file one
+// block at a time.
+
+const size_t COMPRESSED_BLOCK_ROWS      = 1024;
+const int    COMPRESSED_VALUE_COLUMNS   = 6; // price, open, high, low, close, volume
+const int    COMPRESSED_MAX_DECIMALS    = 8;
+
+// One decoded block, reused by the reader for every block it yields
+struct DecodedKlineBlock {
+    size_t  size = 0;
+    int64_t open_time[COMPRESSED_BLOCK_ROWS];
+    double  values[COMPRESSED_VALUE_COLUMNS][COMPRESSED_BLOCK_ROWS]; // price, open, high, low, close, volume
+};
+
+const double DECIMAL_SCALES[COMPRESSED_MAX_DECIMALS + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+
+// Decodes the block at `data` (at most `size` bytes available). Returns the block's byte length,
+// or 0 if the block is malformed.
+size_t decode_kline_block(const uint8_t* data, size_t size, DecodedKlineBlock& block);
+std::vector<uint8_t> encode_kline_blocks(const KlineColumns& klines);
+
+// Decodes a whole compressed file into open_time, price and OHLCV columns
+bool load_compressed_series(const std::string& path, KlineColumns& klines);
+bool convert_db_to_compressed(const std::string& db_path, const std::string& out_path);
+
+// --- Arrow IPC Export ---
+//
+// Writes klines joined with the materialized pi_cycle columns as an Arrow IPC file (Feather v2), so
+// Python/Polars can open it directly with pyarrow.ipc / pl.read_ipc. The metadata is flatbuffers
+// built by the small builder below; the column buffers are little-endian, start on 64-byte file
+// offsets and carry no compression, so a reader can memory-map the file and use them in place.
+// Rows are streamed from SQLite into fixed-size record batches, so memory stays bounded by the
+// batch size no matter how long the history is.
+//
+// File layout: "ARROW1\0\0", Schema message, RecordBatch messages, end-of-stream marker, Footer,
+// int32 footer size, "ARROW1". Each message is 0xFFFFFFFF, int32 metadata size, flatbuffer
+// Message (padded), body.
+
+// Streams klines + pi_cycle into an Arrow IPC file, `batch_rows` rows per record batch. The caller
+// refreshes pi_cycle first. Returns the number of rows written, or -1 on error.
+long long export_arrow(sqlite3* db, const std::string& path, size_t batch_rows);
+
+#endif // BINANCE_KLINES_FORMATS_HPP
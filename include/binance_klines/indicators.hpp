@@ -0,0 +1,275 @@
+// Pi Cycle indicators: the projection, derived columns, SQL window functions and the live row
+#ifndef BINANCE_KLINES_INDICATORS_HPP
+#define BINANCE_KLINES_INDICATORS_HPP
+
+#include "binance_klines/common.hpp"
+#include "binance_klines/formats.hpp"
+
+#include <vector>
+#include <deque>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- SQL Window Functions ---
+//
+// rolling_std(x), pi_ceiling(x) and pi_median(x) are registered on every KlineStore connection (and the
+// unified reader) as aggregate window functions, so the Pi Cycle bands can be queried from SQL:
+//
+//   SELECT open_time, AVG(price) OVER w AS floor, pi_median(price) OVER w AS median,
+//          pi_ceiling(price) OVER w AS ceiling
+//   FROM klines WINDOW w AS (ORDER BY open_time ROWS 364 PRECEDING);
+//
+// Each keeps a count and running sums of x and x^2, so adding a row to the frame (step) and dropping
+// one (inverse) are O(1) and a sliding frame costs O(n) in total. The deviation is the population one,
+// as in price_projection(); the first 364 rows see a partial frame. Prices go in and come out in
+// ticks: divide by kline_scale.price_factor.
+
+bool register_pi_cycle_functions(sqlite3* db);
+
+// --- Pi Cycle Calculation ---
+
+const int PI_CYCLE_LOOKBACK_ROWS = 364; // Earlier rows a day's indicators read (365-row window, 364-day step)
+
+PriceSeriesView price_series_view(const KlineColumns& klines);
+PriceSeriesView price_series_view(const ColumnarSeries& series);
+
+/*----------------------------------------------------------------------------------------------------*/
+// Aggregates over the day-to-day price changes of an already-loaded series. One pass builds prefix
+// sums of the absolute and percentage changes; any trailing-window average is then two lookups, so
+// callers can ask for as many windows as they like without rescanning the series or the database.
+class DailyChangeAggregates {
+public:
+    explicit DailyChangeAggregates(const PriceSeriesView& series)
+        : series_(series), prefix_change_(series.size + 1, 0.0), prefix_move_(series.size + 1, 0.0) {
+        for (size_t i = 1; i < series.size; ++i) {
+            double change = series.price[i] - series.price[i - 1];
+            double move   = (series.price[i - 1] != 0) ? change / series.price[i - 1] * 100.0 : 0.0;
+            prefix_change_[i + 1] = prefix_change_[i] + change;
+            prefix_move_[i + 1]   = prefix_move_[i] + move;
+        }
+    }
+
+    // Mean daily change over the changes between rows [first, size); the change into `first` itself
+    // is excluded, matching LAG() over a filtered window.
+    double average_change_from(size_t first) const {
+        if (first + 1 >= series_.size) return 0.0;
+        return (prefix_change_[series_.size] - prefix_change_[first + 1]) / (double)(series_.size - first - 1);
+    }
+
+    double average_move_from(size_t first) const {
+        if (first + 1 >= series_.size) return 0.0;
+        return (prefix_move_[series_.size] - prefix_move_[first + 1]) / (double)(series_.size - first - 1);
+    }
+
+    // Mean daily change over the last `rows` rows of the series
+    double average_change(size_t rows) const {
+        return average_change_from(rows >= series_.size ? 0 : series_.size - rows);
+    }
+
+    // Mean daily change over rows opened within the last `days` calendar days (UTC), counted from
+    // the start of the current day
+    double average_change_days(int days) const {
+        return average_change_from(first_row_within_days(days));
+    }
+
+    double average_move_days(int days) const {
+        return average_move_from(first_row_within_days(days));
+    }
+
+private:
+    size_t first_row_within_days(int days) const {
+        long long cutoff = trailing_days_cutoff_ms(days);
+        return (size_t)(std::lower_bound(series_.open_time, series_.open_time + series_.size, cutoff) - series_.open_time);
+    }
+
+    PriceSeriesView     series_;
+    std::vector<double> prefix_change_;
+    std::vector<double> prefix_move_;
+};
+
+std::vector<PiCycleData> price_projection(const PriceSeriesView& klines);
+std::vector<PiCycleData> add_calculated_fields(std::vector<PiCycleData> pi_data);
+
+// Indicators for just the newest `num_display_days` rows of `series`, newest first. Only those rows
+// and the PI_CYCLE_LOOKBACK_ROWS before them are read; the earlier rows of the window are inputs
+// whose own indicators are never computed.
+std::vector<PiCycleData> compute_display_rows(PriceSeriesView series, int num_display_days);
+
+// --- Date Queries ---
+//
+// Bands for any day or run of days without recomputing the series. PiCycleIndex is built once over
+// a loaded series in O(n): a table with one entry per calendar day holding the first row at or after
+// that day, and prefix sums of price and price^2. A date or range then maps to rows with two array
+// reads, and every indicator of a row is a difference of prefix sums, so a query costs O(rows
+// returned) regardless of how many years the series holds.
+
+/*----------------------------------------------------------------------------------------------------*/
+class PiCycleIndex {
+public:
+    // `series` must stay valid (mapped, or its KlineColumns alive) while the index is used
+    void build(PriceSeriesView series) {
+        series_ = series;
+        day_start_.clear();
+        prefix_sum_.assign(series.size + 1, 0.0L);
+        prefix_sq_.assign(series.size + 1, 0.0L);
+        if (series.size == 0) return;
+
+        // Extended precision keeps mean(x^2) - mean^2 exact enough at 1e5 prices over 1e6 rows
+        for (size_t i = 0; i < series.size; ++i) {
+            long double price = series.price[i];
+            prefix_sum_[i + 1] = prefix_sum_[i] + price;
+            prefix_sq_[i + 1] = prefix_sq_[i] + price * price;
+        }
+
+        first_day_ = epoch_day(series.open_time[0]);
+        const EpochDay last_day = epoch_day(series.open_time[series.size - 1]);
+        day_start_.resize((size_t)(last_day - first_day_) + 2); // ... plus the day after the last
+        size_t row = 0;
+        for (size_t d = 0; d < day_start_.size(); ++d) {
+            const long long day_begin = epoch_day_to_ms(first_day_ + (EpochDay)d);
+            while (row < series.size && series.open_time[row] < day_begin) ++row;
+            day_start_[d] = (uint32_t)row;
+        }
+    }
+
+    size_t size() const { return series_.size; }
+    EpochDay first_day() const { return first_day_; }
+    EpochDay last_day() const { return first_day_ + (EpochDay)day_start_.size() - 2; }
+
+    // Rows [begin, end) whose open_time falls on the UTC days from..to (inclusive)
+    void rows_for_days(EpochDay from, EpochDay to, size_t& begin, size_t& end) const {
+        begin = end = 0;
+        if (day_start_.empty() || to < from) return;
+        from = std::max(from, first_day());
+        to = std::min(to, last_day());
+        if (to < from) return;
+        begin = day_start_[(size_t)(from - first_day_)];
+        end = day_start_[(size_t)(to - first_day_) + 1];
+    }
+
+    // Every indicator of row i, identical in definition to price_projection() + add_calculated_fields()
+    PiCycleData row(size_t i) const {
+        const double* price = series_.price;
+        PiCycleData r;
+        r.open_time = series_.open_time[i];
+        r.price = price[i];
+        if (i >= 1) {
+            r.change = price[i] - price[i - 1];
+            if (price[i - 1] != 0) r.move = r.change / price[i - 1] * 100.0;
+        }
+        if (i >= (size_t)PI_CYCLE_LOOKBACK_ROWS) {
+            const size_t first = i - PI_CYCLE_LOOKBACK_ROWS;
+            const long double n = PI_CYCLE_LOOKBACK_ROWS + 1;
+            const long double mean = (prefix_sum_[i + 1] - prefix_sum_[first]) / n;
+            const long double variance = (prefix_sq_[i + 1] - prefix_sq_[first]) / n - mean * mean;
+            r.ma_365 = (double)mean;
+            r.std_365 = std::sqrt(std::max(0.0, (double)variance));
+            r.ceiling = r.ma_365 + (2 * r.std_365);
+            r.floor = r.ma_365;
+            r.median = (r.ceiling + r.floor) / 2.0;
+            // The 364 daily changes of the step window telescope to one difference
+            r.dynamic_step = r.step = (price[i] - price[first]) / PI_CYCLE_LOOKBACK_ROWS;
+            if (price[first] != 0) r.weeks_52 = ((price[i] - price[first]) / price[first]) * 100.0;
+        }
+        if (r.median != 0) r.offset = ((r.price - r.median) / r.median) * 100.0;
+        return r;
+    }
+
+    // Rows of the days from..to, newest first like the display rows
+    std::vector<PiCycleData> query(EpochDay from, EpochDay to) const {
+        size_t begin, end;
+        rows_for_days(from, to, begin, end);
+        std::vector<PiCycleData> rows;
+        rows.reserve(end - begin);
+        for (size_t i = end; i > begin; --i) rows.push_back(row(i - 1));
+        return rows;
+    }
+
+private:
+    PriceSeriesView          series_;
+    EpochDay                 first_day_ = 0;
+    std::vector<uint32_t>    day_start_;
+    std::vector<long double> prefix_sum_;
+    std::vector<long double> prefix_sq_;
+};
+
+// --- Live Row ---
+
+/*----------------------------------------------------------------------------------------------------*/
+// Indicators of the newest (live) row, with the same definitions as PiCycleIndex::row()
+class LivePiCycle {
+public:
+    // `series` ascending; its last row becomes the live one
+    void reset(PriceSeriesView series) {
+        const size_t keep = std::min(series.size, (size_t)PI_CYCLE_LOOKBACK_ROWS + 1);
+        open_time_ = series.size ? series.open_time[series.size - 1] : 0;
+        prices_.assign(series.price + series.size - keep, series.price + series.size);
+        sum_closed();
+    }
+
+    long long open_time() const { return open_time_; }
+
+    void set_price(double price) {
+        if (!prices_.empty()) prices_.back() = price;
+    }
+
+    // Closes the live row at its current price and opens a new one at the same price
+    void roll(long long open_time) {
+        open_time_ = open_time;
+        prices_.push_back(prices_.empty() ? 0.0 : prices_.back());
+        if (prices_.size() > (size_t)PI_CYCLE_LOOKBACK_ROWS + 1) prices_.pop_front();
+        sum_closed();
+    }
+
+    PiCycleData row() const {
+        PiCycleData r;
+        r.open_time = open_time_;
+        r.price = prices_.empty() ? 0.0 : prices_.back();
+        const size_t n = prices_.size();
+        if (n >= 2) {
+            r.change = r.price - prices_[n - 2];
+            if (prices_[n - 2] != 0) r.move = r.change / prices_[n - 2] * 100.0;
+        }
+        if (n == (size_t)PI_CYCLE_LOOKBACK_ROWS + 1) {
+            const long double count = PI_CYCLE_LOOKBACK_ROWS + 1;
+            const long double price = r.price;
+            const long double mean = (closed_sum_ + price) / count;
+            const long double variance = (closed_sq_ + price * price) / count - mean * mean;
+            const double first = prices_.front();
+            r.ma_365 = (double)mean;
+            r.std_365 = std::sqrt(std::max(0.0, (double)variance));
+            r.ceiling = r.ma_365 + (2 * r.std_365);
+            r.floor = r.ma_365;
+            r.median = (r.ceiling + r.floor) / 2.0;
+            r.dynamic_step = r.step = (r.price - first) / PI_CYCLE_LOOKBACK_ROWS;
+            if (first != 0) r.weeks_52 = ((r.price - first) / first) * 100.0;
+        }
+        if (r.median != 0) r.offset = ((r.price - r.median) / r.median) * 100.0;
+        return r;
+    }
+
+private:
+    void sum_closed() {
+        closed_sum_ = closed_sq_ = 0.0L;
+        for (size_t i = 0; i + 1 < prices_.size(); ++i) {
+            closed_sum_ += prices_[i];
+            closed_sq_ += (long double)prices_[i] * prices_[i];
+        }
+    }
+
+    long long          open_time_ = 0;
+    std::deque<double> prices_;      // Window of the live row, oldest first, live price last
+    long double        closed_sum_ = 0.0L;
+    long double        closed_sq_  = 0.0L;
+};
+
+// Recomputes the newest display row at the live `price`. If the candle in progress is not stored yet,
+// `live` rolls into it and the row is added at the top. Returns false (rows untouched) when the stored
+// candles end before the previous period, so there is no window to extend.
+bool overlay_live_row(LivePiCycle& live, double price, std::vector<PiCycleData>& rows);
+
+#endif // BINANCE_KLINES_INDICATORS_HPP
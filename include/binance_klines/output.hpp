@@ -0,0 +1,221 @@
+// Buffered std::cout/std::cerr with syscall counters
+#ifndef BINANCE_KLINES_OUTPUT_HPP
+#define BINANCE_KLINES_OUTPUT_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+// For write()/writev() on the standard streams (POSIX)
+#include <sys/uio.h>
+#include <unistd.h>
+
+// --- Output Sink ---
+//
+// std::cout and std::cerr write through an OutputSink: a std::streambuf over a large buffer that
+// counts its own syscalls. When stdout is a file or a pipe, std::endl no longer costs one write() per
+// line; the buffer goes out when it fills, at explicit flush points (flush_output() before blocking on
+// the network, before anything reaches stderr, at exit), and large blocks such as the rendered table
+// leave together with the pending bytes in a single writev(). On a terminal std::endl still flushes,
+// so progress stays visible. --stats prints the counters at exit in the style of `strace -c`.
+
+const size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+bool write_all(int fd, const void* buffer, size_t length);
+
+struct OutputStats {
+    unsigned long long write_calls    = 0;
+    unsigned long long writev_calls   = 0;
+    unsigned long long bytes          = 0;
+    unsigned long long flushes        = 0; // Non-empty buffers sent
+    unsigned long long syncs_deferred = 0; // std::endl / std::flush requests absorbed by the buffer
+    double             syscall_ms     = 0.0;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+class OutputSink : public std::streambuf {
+public:
+    // `flush_on_sync`: honor std::endl/std::flush immediately. `before` is flushed ahead of every
+    // write to this sink, which keeps stdout and stderr in order when they share a file.
+    OutputSink(int fd, size_t capacity, bool flush_on_sync, OutputSink* before = nullptr)
+        : fd_(fd), buffer_(capacity), used_(0), flush_on_sync_(flush_on_sync), before_(before) {}
+    ~OutputSink() { flush(); }
+
+    // Explicit flush point
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return send(nullptr, 0);
+    }
+
+    // Appends `length` bytes. A block too large for the free space goes out in the same writev()
+    // as the pending bytes instead of being copied.
+    bool write_block(const char* data, size_t length) {
+        if (before_) before_->flush();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return append(data, length);
+    }
+
+    OutputStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+protected:
+    // No put area: every character reaches xsputn/overflow, so the sink is safe to share across threads
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        char ch = traits_type::to_char_type(c);
+        return write_block(&ch, 1) ? c : traits_type::eof();
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        return write_block(s, (size_t)n) ? n : 0;
+    }
+
+    int sync() override {
+        if (flush_on_sync_) return flush() ? 0 : -1;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.syncs_deferred;
+        return 0;
+    }
+
+private:
+    OutputSink(const OutputSink&);
+    OutputSink& operator=(const OutputSink&);
+
+    bool append(const char* data, size_t length) {
+        if (used_ + length <= buffer_.size()) {
+            std::memcpy(buffer_.data() + used_, data, length);
+            used_ += length;
+            return true;
+        }
+        if (length >= buffer_.size() / 2) return send(data, length);
+        if (!send(nullptr, 0)) return false;
+        std::memcpy(buffer_.data(), data, length);
+        used_ = length;
+        return true;
+    }
+
+    // Writes the pending bytes followed by `extra`, retrying partial writes
+    bool send(const char* extra, size_t extra_length) {
+        struct iovec iov[2];
+        int count = 0;
+        if (used_ > 0) iov[count++] = {buffer_.data(), used_};
+        if (extra_length > 0) iov[count++] = {const_cast<char*>(extra), extra_length};
+        if (count == 0) return true;
+        ++stats_.flushes;
+        used_ = 0;
+
+        struct iovec* next = iov;
+        while (count > 0) {
+            auto start = std::chrono::steady_clock::now();
+            ssize_t written;
+            if (count == 1) {
+                written = ::write(fd_, next->iov_base, next->iov_len);
+                ++stats_.write_calls;
+            } else {
+                written = ::writev(fd_, next, count);
+                ++stats_.writev_calls;
+            }
+            stats_.syscall_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            stats_.bytes += (unsigned long long)written;
+            size_t remaining = (size_t)written;
+            while (count > 0 && remaining >= next->iov_len) {
+                remaining -= next->iov_len;
+                ++next;
+                --count;
+            }
+            if (count > 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+                next->iov_len -= remaining;
+            }
+        }
+        return true;
+    }
+
+    int               fd_;
+    std::vector<char> buffer_;
+    size_t            used_;
+    bool              flush_on_sync_;
+    OutputSink*       before_;
+    std::mutex        mutex_;
+    OutputStats       stats_;
+};
+
+extern OutputSink* g_stdout_sink; // Installed by OutputSinkScope for the lifetime of main()
+
+// Explicit flush point for output that should be visible before a slow operation
+void flush_output();
+
+/*----------------------------------------------------------------------------------------------------*/
+// Routes std::cout/std::cerr through OutputSinks until the end of the scope. Stdout is fully
+// buffered unless it is a terminal; stderr flushes on every std::endl but writes stdout out first.
+class OutputSinkScope {
+public:
+    OutputSinkScope()
+        : stdout_sink_(STDOUT_FILENO, OUTPUT_BUFFER_SIZE, isatty(STDOUT_FILENO) == 1),
+          stderr_sink_(STDERR_FILENO, 64 * 1024, true, &stdout_sink_),
+          cout_buf_(std::cout.rdbuf(&stdout_sink_)),
+          cerr_buf_(std::cerr.rdbuf(&stderr_sink_)),
+          report_stats_(false) {
+        g_stdout_sink = &stdout_sink_;
+    }
+    ~OutputSinkScope() {
+        if (report_stats_) print_stats();
+        stdout_sink_.flush();
+        stderr_sink_.flush();
+        std::cout.rdbuf(cout_buf_);
+        std::cerr.rdbuf(cerr_buf_);
+        g_stdout_sink = nullptr;
+    }
+
+    void report_stats_at_exit() { report_stats_ = true; }
+
+    // Syscall summary of both streams, written straight to stderr after everything else
+    void print_stats() {
+        stdout_sink_.flush();
+        stderr_sink_.flush();
+        OutputStats streams[2] = {stdout_sink_.stats(), stderr_sink_.stats()};
+        const char* names[2] = {"stdout", "stderr"};
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(3)
+               << "+--------+---------+----------+------------+---------+-------------+-------------+\n"
+               << "| Stream | write() | writev() |   Bytes    | Flushes | endl/flush  | Syscall ms  |\n"
+               << "|        |  calls  |  calls   |            |         |  deferred   |             |\n"
+               << "+--------+---------+----------+------------+---------+-------------+-------------+\n";
+        for (int s = 0; s < 2; ++s) {
+            report << "| " << std::setw(6) << std::left << names[s] << std::right
+                   << " | " << std::setw(7) << streams[s].write_calls
+                   << " | " << std::setw(8) << streams[s].writev_calls
+                   << " | " << std::setw(10) << streams[s].bytes
+                   << " | " << std::setw(7) << streams[s].flushes
+                   << " | " << std::setw(11) << streams[s].syncs_deferred
+                   << " | " << std::setw(11) << streams[s].syscall_ms << " |\n";
+        }
+        report << "+--------+---------+----------+------------+---------+-------------+-------------+\n";
+        const std::string text = report.str();
+        write_all(STDERR_FILENO, text.data(), text.size());
+    }
+
+private:
+    OutputSinkScope(const OutputSinkScope&);
+    OutputSinkScope& operator=(const OutputSinkScope&);
+
+    OutputSink      stdout_sink_;
+    OutputSink      stderr_sink_;
+    std::streambuf* cout_buf_;
+    std::streambuf* cerr_buf_;
+    bool            report_stats_;
+};
+
+#endif // BINANCE_KLINES_OUTPUT_HPP
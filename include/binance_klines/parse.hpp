@@ -0,0 +1,68 @@
+// Parsing of exchange payloads: fixed-point prices, dates, symbols and interval names
+#ifndef BINANCE_KLINES_PARSE_HPP
+#define BINANCE_KLINES_PARSE_HPP
+
+#include "binance_klines/common.hpp"
+
+#include <string>
+#include <vector>
+
+// --- Date Parsing ---
+
+// Parses "YYYY-MM-DD", rejecting dates that do not exist (e.g. 2021-02-30)
+bool parse_ymd(const std::string& text, EpochDay& day);
+
+// --- Fixed-Point Prices ---
+//
+// Prices are parsed from the exchange's decimal strings straight into integer ticks and stay integers
+// through storage and change detection; they become doubles only when loaded for the indicator
+// kernels. The tick scale is per partition: the number of decimals of the symbol's PRICE_FILTER
+// tickSize, recorded in kline_scale before the first candle is written.
+
+const int        PRICE_MAX_DECIMALS = 8; // Binance quotes every price with 8 decimals
+const PriceTicks PRICE_SCALES[PRICE_MAX_DECIMALS + 1] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL
+};
+
+// Parses a plain decimal string ("67012.34000000") into ticks of 10^-decimals. Digits past the scale
+// must be zeros, so a price that is not a whole number of ticks is rejected instead of rounded.
+bool parse_price_ticks(const std::string& text, int decimals, PriceTicks& ticks);
+
+// Decimals of an exchange tickSize: "0.01000000" -> 2, "1.00000000" -> 0. Returns -1 if unusable.
+int tick_size_decimals(const std::string& tick_size);
+
+// --- Symbols and Intervals ---
+//
+// Symbols and intervals name partition files and are pasted into the unified reader's view, so
+// command-line input is checked against these before a partition is registered.
+
+// Exchange symbol: one or more of A-Z and 0-9 ("BTCUSDT")
+bool valid_symbol(const std::string& symbol);
+
+// One of the exchange's kline intervals, 1s through 1M
+bool valid_interval(const std::string& interval);
+
+// Candle length of a Binance interval string in ms, or 0 for intervals of variable length (1M)
+long long interval_ms(const std::string& interval);
+
+// --- Exchange Payloads ---
+//
+// The REST replies are parsed apart from the transport in fetch, so a caller with its own HTTP
+// client (or a recorded reply) goes through the same checks. Malformed bodies and error replies are
+// reported on stderr like the network errors around them.
+
+// Price decimals of `symbol` from the PRICE_FILTER tickSize of an /api/v3/exchangeInfo reply, or -1
+int parse_exchange_info_decimals(const std::string& body, const std::string& symbol);
+
+// Candles of an /api/v3/klines reply with prices in ticks of 10^-price_decimals. Empty when the
+// reply is an error or malformed, or when any price is off that grid, which sets `*off_grid`.
+std::vector<Kline> parse_klines(const std::string& body, const std::string& symbol, int price_decimals,
+                                bool* off_grid = nullptr);
+
+// Bid, ask and last of a Gemini /v1/pubticker reply; fields that could not be read stay as they are
+bool parse_gemini_ticker(const std::string& body, Ticker& ticker);
+
+// Bid, ask and last of a Binance /api/v3/ticker/24hr reply; all zero when it could not be read
+bool parse_binance_ticker(const std::string& body, Ticker& ticker);
+
+#endif // BINANCE_KLINES_PARSE_HPP
@@ -0,0 +1,119 @@
+// Projections: horizons, the step projection table, Monte Carlo bands and walk-forward scoring
+#ifndef BINANCE_KLINES_PROJECTION_HPP
+#define BINANCE_KLINES_PROJECTION_HPP
+
+#include "binance_klines/common.hpp"
+#include "binance_klines/store.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// --- Projection Horizons ---
+//
+// The projection under the table extends the newest row's median along two slopes. One is the
+// average step of the newest PROJECTION_STEP_ROWS rows; the other is the long-run average daily
+// increase. A horizon is any number of days ahead: "+30d", "+4w", a date, or the end of the current
+// or a later quarter or year ("qe", "ye", "ye2"). Horizons are resolved once against today's UTC
+// epoch day, with integer calendar math and no mktime/localtime. project_horizons() then evaluates
+// every horizon for every symbol in one pass over struct-of-arrays inputs, as plain multiply-adds
+// that the compiler vectorizes. --project-all loads the newest rows of every partition in parallel
+// and prints the whole grid.
+
+const int PROJECTION_STEP_ROWS  = 30;          // Newest rows whose steps are averaged
+const int PROJECTION_TREND_DAYS = 365 * 4 + 1; // Calendar days behind the long-run average daily increase
+const char* const DEFAULT_HORIZONS = "ye,+30d";
+
+struct ProjectionHorizon {
+    std::string label; // As shown in the Target column
+    int         days;  // From today (UTC)
+};
+
+// Horizons from a comma-separated list of "+N"/"+Nd"/"Nd" days, "+Nw"/"Nw" weeks, YYYY-MM-DD dates and
+// "qe"/"ye" (optionally "qe2", "ye3", ...: the second, third... end from today). Returns false on a
+// malformed entry; horizons that are not after today are dropped.
+bool parse_horizons(const std::string& spec, EpochDay today, std::vector<ProjectionHorizon>& horizons);
+
+// Per-symbol inputs of the projection, one array per field
+struct ProjectionInputs {
+    std::vector<std::string> symbols;
+    std::vector<double>      baseline;       // Newest row's median
+    std::vector<double>      average_step;   // Mean step of the newest PROJECTION_STEP_ROWS rows
+    std::vector<double>      daily_increase; // Long-run average daily increase
+};
+
+// Projected prices, horizon-major: [h * symbols + s]
+struct ProjectionGrid {
+    std::vector<double> step;
+    std::vector<double> trend;
+};
+
+// Step and trend projections of every symbol in `inputs` at every horizon, into `grid` (resized to
+// horizons x symbols). Pure arithmetic: nothing is printed or read from disk.
+void project_horizons(const ProjectionInputs& inputs, const std::vector<ProjectionHorizon>& horizons, ProjectionGrid& grid);
+
+// Prints the projection table under the indicator table from the display rows (newest first)
+void prediction_target_step(const std::vector<PiCycleData>& pi_data_reversed, double avg_daily_increase,
+                            const std::vector<ProjectionHorizon>& horizons);
+
+// Projects every `interval` partition in the catalog at every horizon: the inputs are loaded on up to
+// `threads` workers, then one project_horizons() call computes the whole grid
+void run_projection_grid(KlineCatalog& catalog, const std::string& interval, const std::vector<ProjectionHorizon>& horizons, int threads);
+
+// --- Monte Carlo Projection ---
+//
+// prediction_target_step() extends one straight line from today's median. --monte-carlo instead
+// simulates price paths from the historical candle-to-candle log returns of the trend window and
+// reports percentile bands of the price on each target date. There are two models:
+//   bootstrap  every step draws one historical return, with replacement
+//   gbm        geometric Brownian motion with the mean and standard deviation of those returns
+// The random numbers come from a counter-based generator. The draw of path p at step s is a hash of p
+// under a key derived from the seed and s, so no generator state is carried between steps or shared
+// between threads. Any block of paths can run on any worker, and the bands do not depend on --threads.
+// Paths are stepped in blocks of MC_BLOCK_PATHS lanes whose log prices stay in L1. The inner loop
+// over lanes is branch-free, so the compiler vectorizes it, including the gather from the return
+// table; GCC on x86-64 also builds an AVX2 clone of it, chosen at load time. Only the log prices on
+// the target dates are kept. GBM increments are exact over any span, so that model steps straight
+// from one target date to the next.
+
+enum MonteCarloModel { MC_BOOTSTRAP, MC_GBM };
+
+const size_t MC_DEFAULT_PATHS = 1000000;
+const double MC_PERCENTILES[] = {5.0, 25.0, 50.0, 75.0, 95.0};
+const size_t MC_PERCENTILE_COUNT = sizeof(MC_PERCENTILES) / sizeof(MC_PERCENTILES[0]);
+
+struct MonteCarloBand {
+    int    steps = 0;                    // Candles from the newest row to the target
+    double price[MC_PERCENTILE_COUNT];   // At MC_PERCENTILES
+    double mean  = 0.0;
+};
+
+// Log returns between consecutive rows, for rows opened at or after from_ms
+std::vector<double> log_returns_since(PriceSeriesView series, long long from_ms);
+
+// Percentile bands of `paths` simulated prices, starting at start_price, after each of
+// `horizon_steps` (ascending, > 0) candles. Empty when there are no returns to draw from.
+std::vector<MonteCarloBand> simulate_price_bands(const std::vector<double>& log_returns, MonteCarloModel model,
+                                                 double start_price, const std::vector<int>& horizon_steps,
+                                                 size_t paths, int threads, uint64_t seed);
+
+// Band table in place of the step projection
+void print_monte_carlo(const std::vector<MonteCarloBand>& bands, const std::vector<ProjectionHorizon>& targets,
+                       MonteCarloModel model, size_t paths, size_t returns, double ms, int threads);
+
+// --- Walk-Forward Evaluation ---
+//
+// How good has the projection under the table been? --walk-forward rebuilds, for every stored day, the
+// numbers prediction_target_step() would have printed that day. It then compares them with the price
+// actually reached N days later and on the last day of that year. The state is carried forward
+// instead of recomputed: PiCycleIndex gives each row's median in O(1), a running sum holds the newest
+// PROJECTION_STEP_ROWS steps, and the long-run average daily increase telescopes to
+// (price[i] - price[first]) / (i - first) behind a pointer that only moves forward. A series is
+// evaluated in O(n), and the partitions are evaluated in parallel. A naive "price stays where it is"
+// forecast is scored alongside as the bar to beat.
+
+// Evaluates every `interval` partition in the catalog on up to `threads` workers and prints one block
+// of rows per partition plus the pooled totals
+void run_walk_forward(KlineCatalog& catalog, const std::string& interval, int horizon_days, int threads);
+
+#endif // BINANCE_KLINES_PROJECTION_HPP
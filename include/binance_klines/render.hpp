@@ -0,0 +1,143 @@
+// Text output: the indicator table, date queries, live quotes and the CSV/JSON series export
+#ifndef BINANCE_KLINES_RENDER_HPP
+#define BINANCE_KLINES_RENDER_HPP
+
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/fetch.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Table Renderer ---
+//
+// The indicator table is rendered into one buffer sized up front and goes to stdout in a single
+// write() (a writev() with whatever the output sink still holds). The column layout is a constexpr
+// descriptor table and numbers are formatted by hand (digit pairs, exact rounding, thousands
+// separators), so a row costs no allocation, no stream state and no map lookups.
+
+// Whole-number string with thousands separators; empty for NaN
+std::string format_numeric(double value);
+
+enum PiTableValue {
+    PI_TABLE_DATE, PI_TABLE_PRICE, PI_TABLE_MOVE, PI_TABLE_OFFSET, PI_TABLE_CEILING, PI_TABLE_MEDIAN,
+    PI_TABLE_FLOOR, PI_TABLE_STEP, PI_TABLE_CHANGE, PI_TABLE_WEEKS_52
+};
+
+struct PiTableColumn {
+    PiTableValue value;
+    int          width;    // Minimum cell width, like std::setw
+    bool         left;     // std::left instead of std::right
+    bool         space;    // Cell text starts with a space (counted in the width)
+    int          decimals;
+    bool         percent;  // Ungrouped with a '%' suffix; otherwise grouped, NaN left blank
+};
+
+constexpr PiTableColumn PI_TABLE_COLUMNS[] = {
+    {PI_TABLE_DATE,     10, true,  true,  0, false},
+    {PI_TABLE_PRICE,     9, false, false, 0, false},
+    {PI_TABLE_MOVE,      7, false, true,  2, true},
+    {PI_TABLE_OFFSET,    7, false, false, 1, true},
+    {PI_TABLE_CEILING,   9, false, false, 0, false},
+    {PI_TABLE_MEDIAN,    9, false, false, 0, false},
+    {PI_TABLE_FLOOR,     9, false, false, 0, false},
+    {PI_TABLE_STEP,      5, false, false, 0, false},
+    {PI_TABLE_CHANGE,    7, false, false, 0, false},
+    {PI_TABLE_WEEKS_52,  9, false, true,  2, true}
+};
+const size_t PI_TABLE_COLUMN_COUNT = sizeof(PI_TABLE_COLUMNS) / sizeof(PI_TABLE_COLUMNS[0]);
+
+const char PI_TABLE_RULE[]   = "+------------+----------+--------+--------+----------+----------+----------+------+--------+----------+\n";
+const char PI_TABLE_HEADER[] = "|    Date    |   Price  |  Move  | Offset | CEILING  |  MEDIAN  |  FLOOR   | Step | Change | 52-weeks |\n";
+const size_t PI_TABLE_ROW_BYTES      = 160;  // Colored row with ordinary values
+const size_t PI_TABLE_CELL_MAX_BYTES = 448;  // A 300-digit number with separators
+const size_t PI_TABLE_ROW_MAX_BYTES  = 4600; // Worst case: every cell a 300-digit number
+const char   COLOR_RESET[]           = "\033[0m";
+
+// Row color from where the price sits between floor, median and ceiling
+const char* pi_row_color(const PiCycleData& row);
+
+/*----------------------------------------------------------------------------------------------------*/
+inline char* append_text(char* out, const char* text, size_t length) {
+    std::memcpy(out, text, length);
+    return out + length;
+}
+
+// One padded cell of `row` without its " |" separator; `out` needs PI_TABLE_CELL_MAX_BYTES.
+// Returns the new end.
+char* render_pi_cell(char* out, const PiCycleData& row, const PiTableColumn& column);
+
+// One colored table row, newline included; `out` needs PI_TABLE_ROW_MAX_BYTES. Returns the new end.
+char* render_pi_row(char* out, const PiCycleData& row);
+void display_public(const std::vector<PiCycleData>& pi_data_reversed);
+
+// --- Date Queries ---
+
+// Prints the rows of the days from..to. Returns false if the series has none there.
+bool run_date_query(PriceSeriesView series, EpochDay from, EpochDay to);
+
+// --- Series Export ---
+//
+// --format=csv|json|ndjson writes the indicator series, oldest first, for machine consumers. The
+// writer streams: each row is formatted into a fixed stack buffer and handed to the output sink, so
+// nothing is collected and no json objects are built. Doubles use the shortest representation that
+// reads back to the same value, found in one pass by Grisu2 (grisu2.hpp); non-finite values are null
+// in JSON and empty in CSV. From SQLite the rows are read with one cursor over pi_cycle, so memory
+// stays constant however long the series is.
+
+enum SeriesFormat { SERIES_CSV, SERIES_JSON, SERIES_NDJSON };
+
+struct SeriesField {
+    const char*          name;
+    double PiCycleData::* member;
+};
+
+constexpr SeriesField SERIES_FIELDS[] = {
+    {"price",   &PiCycleData::price},   {"ma_365", &PiCycleData::ma_365}, {"std_365",  &PiCycleData::std_365},
+    {"ceiling", &PiCycleData::ceiling}, {"median", &PiCycleData::median}, {"floor",    &PiCycleData::floor},
+    {"step",    &PiCycleData::step},    {"change", &PiCycleData::change}, {"move",     &PiCycleData::move},
+    {"offset",  &PiCycleData::offset},  {"weeks_52", &PiCycleData::weeks_52}
+};
+
+bool parse_series_format(const std::string& name, SeriesFormat& format);
+
+/*----------------------------------------------------------------------------------------------------*/
+class SeriesWriter {
+public:
+    // Rows go to the output sink, or are appended to `buffer` when one is given
+    explicit SeriesWriter(SeriesFormat format, std::string* buffer = nullptr) : format_(format), rows_(0), buffer_(buffer) {}
+
+    void begin();
+    void row(const PiCycleData& data);
+    void end();
+    size_t rows() const { return rows_; }
+
+private:
+    char* number(char* out, double value) const;
+    void emit(const char* data, size_t length);
+
+    SeriesFormat format_;
+    size_t       rows_;
+    std::string* buffer_;
+};
+
+// Streams the pi_cycle rows with from_ms <= open_time <= to_ms through `writer`. Returns the number of
+// rows written, or -1 on error.
+long long export_pi_cycle(sqlite3* db, long long from_ms, long long to_ms, SeriesWriter& writer);
+
+// Same for a mapped or loaded series, computing each row from a PiCycleIndex
+long long export_series(PriceSeriesView series, EpochDay from, EpochDay to, SeriesWriter& writer);
+
+// --- Live Quotes ---
+
+// Venue table under the indicator table; prices with the partition's `decimals`
+void print_live_quotes(const std::vector<VenueQuote>& quotes, const MergedQuote& merged, int decimals);
+
+#endif // BINANCE_KLINES_RENDER_HPP
@@ -0,0 +1,26 @@
+// Band server: the indicator series over HTTP/JSON
+#ifndef BINANCE_KLINES_SERVE_HPP
+#define BINANCE_KLINES_SERVE_HPP
+
+#include "binance_klines/store.hpp"
+
+#include <string>
+
+// --- Band Server ---
+//
+// --serve answers GET /bands?symbol=&from=&to= over HTTP/1.1 on 127.0.0.1:<port> or a Unix socket.
+// One thread runs a level-triggered epoll loop over non-blocking sockets with keep-alive. The series
+// of each requested partition stays in memory, indexed by PiCycleIndex, so a reply costs
+// microseconds. Each cached series keeps its partition connection open and compares PRAGMA
+// data_version before it answers. Any commit by another connection (a normal run, --backfill,
+// --fill-gaps) changes it, and the series is then reloaded and reindexed first. Without from/to the
+// reply holds the newest row only. Rows are JSON objects as in --format=json, oldest first.
+
+int run_band_server(KlineCatalog& catalog, const std::string& address);
+
+// Load test: starts a BandServer on a scratch Unix socket and has `clients` keep-alive connections
+// send `requests` GETs in total, for the newest row and for a 30-day range, reporting throughput
+// and latency percentiles.
+void run_serve_benchmark(KlineCatalog& catalog, int requests, int clients);
+
+#endif // BINANCE_KLINES_SERVE_HPP
@@ -0,0 +1,301 @@
+// SQLite storage: the klines schema and its migrations, partitions, gap scans and the pi_cycle table
+#ifndef BINANCE_KLINES_STORE_HPP
+#define BINANCE_KLINES_STORE_HPP
+
+#include "binance_klines/common.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/indicators.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// For stat() and mkdir() on partition files (POSIX)
+#include <sys/stat.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Klines Table ---
+
+// Schema history (tracked in PRAGMA user_version):
+//   1 - legacy: dt1 DATE text key with a separate UNIQUE index over a hidden rowid B-tree
+//   2 - open_time INTEGER (ms since epoch, UTC) as a clustered WITHOUT ROWID primary key
+//   3 - full Binance kline payload: close_time, quote_volume and taker buy base/quote volumes
+//   4 - materialized pi_cycle indicator table plus triggers that track which days need recomputing
+//   5 - price/open/high/low/close as INTEGER ticks of 10^-price_decimals, recorded in kline_scale
+const int KLINES_SCHEMA_VERSION = 5;
+
+std::string klines_table_sql(const std::string& table_name);
+bool exec_sql(sqlite3* db, const std::string& sql, const char* context);
+void create_klines_table(sqlite3* db);
+
+// The partition's price decimals, or -1 before the first fetch has recorded them
+int stored_price_decimals(sqlite3* db);
+
+// Divisor that turns stored ticks into prices. A partition without a recorded scale only holds rows
+// written with the default (benchmarks), so that is assumed.
+double price_factor(sqlite3* db);
+
+// Records the scale unless one is already there; only rescale_prices() changes it afterwards.
+bool store_price_decimals(sqlite3* db, int decimals);
+
+// Moves the partition to a finer tick in one transaction, multiplying every stored price to match.
+// A tick no finer than the recorded one leaves the partition as it is.
+bool rescale_prices(sqlite3* db, int decimals);
+
+// Upsert of one candle, bound by bind_kline()
+extern const char* KLINES_UPSERT_SQL;
+
+void bind_kline(sqlite3_stmt* stmt, const Kline& kline);
+
+// Writes only the candles that are new or differ from what is stored. The stored rows covering the
+// batch are read with one range scan and compared field by field (prices are exact integer ticks),
+// so re-polling an unchanged history costs a read and no page writes. The newest candle in the table
+// carries its close as price (see update_current_date_price_with_close()); that is applied before
+// comparing so an unchanged live candle is skipped too.
+UpsertStats insert_klines_data(sqlite3* db, const std::vector<Kline>& klines);
+
+// Reads only the requested columns (a mask of KlineColumn bits) in open_time order. Columns that
+// were not asked for are neither selected nor allocated, so a price-only consumer never pays for
+// the volume fields. Price columns are converted from ticks here, on their way to the kernels.
+KlineColumns load_kline_columns(sqlite3* db, unsigned columns);
+
+// Open time and price for every row at or after `from_open_time`, preceded by up to `lookback_rows`
+// earlier rows. Both halves are range reads on the open_time primary key.
+KlineColumns load_price_window(sqlite3* db, long long from_open_time, int lookback_rows);
+
+// The newest `rows` open_time/price pairs in ascending order, read backwards along the primary key so
+// the cost depends on `rows` and not on the length of the history.
+KlineColumns load_price_tail(sqlite3* db, int rows);
+void update_current_date_price_with_close(sqlite3* db);
+
+// --- Partitioned Storage ---
+//
+// Each symbol/interval lives in its own database file so independent symbols never contend for
+// SQLite's single writer lock. catalog.db maps (symbol, interval) to the partition path; the
+// original binance.db is registered as the BTCUSDT 1d partition so existing data stays where it is.
+
+/*----------------------------------------------------------------------------------------------------*/
+// One open partition. Opening applies the schema/migrations, registers the SQL window functions and
+// switches the file to WAL so readers are not blocked while a writer ingests.
+class KlineStore {
+public:
+    KlineStore() {}
+    ~KlineStore() { close(); }
+    KlineStore(const KlineStore&) = delete;
+    KlineStore& operator=(const KlineStore&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        if (sqlite3_open(path.c_str(), &db_) != SQLITE_OK) {
+            std::cerr << "Can't open database " << path << ": " << sqlite3_errmsg(db_) << std::endl;
+            close();
+            return false;
+        }
+        path_ = path;
+        sqlite3_busy_timeout(db_, 5000);
+        exec_sql(db_, "PRAGMA journal_mode = WAL;", "KlineStore::open");
+        create_klines_table(db_);
+        register_pi_cycle_functions(db_);
+        if (g_debug_enabled) {
+            std::cout << "Debug: Opened database " << path << " successfully." << std::endl;
+        }
+        return true;
+    }
+
+    void close() {
+        if (db_) sqlite3_close(db_);
+        db_ = nullptr;
+    }
+
+    sqlite3* db() const { return db_; }
+    const std::string& path() const { return path_; }
+
+private:
+    sqlite3*    db_ = nullptr;
+    std::string path_;
+};
+
+struct PartitionInfo {
+    std::string symbol;
+    std::string interval;
+    std::string path;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+class KlineCatalog {
+public:
+    KlineCatalog() {}
+    ~KlineCatalog() { if (db_) sqlite3_close(db_); }
+    KlineCatalog(const KlineCatalog&) = delete;
+    KlineCatalog& operator=(const KlineCatalog&) = delete;
+
+    bool open(const std::string& path) {
+        if (sqlite3_open(path.c_str(), &db_) != SQLITE_OK) {
+            std::cerr << "Can't open catalog " << path << ": " << sqlite3_errmsg(db_) << std::endl;
+            return false;
+        }
+        sqlite3_busy_timeout(db_, 5000);
+        return exec_sql(db_, R"(
+                   CREATE TABLE IF NOT EXISTS partitions (
+                       symbol   TEXT NOT NULL,
+                       interval TEXT NOT NULL,
+                       path     TEXT NOT NULL,
+                       PRIMARY KEY (symbol, interval)
+                   ) WITHOUT ROWID;
+               )", "KlineCatalog::open")
+            && exec_sql(db_, "INSERT OR IGNORE INTO partitions (symbol, interval, path) VALUES ('BTCUSDT', '1d', '"
+                             + DB_PATH + "');", "KlineCatalog::open");
+    }
+
+    // Path of the partition for symbol/interval: the registered one, else PARTITION_DIR/<symbol>-<interval>.db.
+    // Looking a pair up does not register it; register_partition() does, once a fetch has filled it.
+    std::string partition_path(const std::string& symbol, const std::string& interval) const {
+        sqlite3_stmt* stmt;
+        std::string path;
+        if (sqlite3_prepare_v2(db_, "SELECT path FROM partitions WHERE symbol = ? AND interval = ?;", -1, &stmt, 0) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, interval.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            }
+        }
+        sqlite3_finalize(stmt);
+        return path.empty() ? PARTITION_DIR + "/" + symbol + "-" + interval + ".db" : path;
+    }
+
+    // Adds symbol/interval -> path unless the pair is registered already. Every registered partition
+    // takes an ATTACH slot in open_unified_reader(), so malformed names are refused.
+    bool register_partition(const std::string& symbol, const std::string& interval, const std::string& path) {
+        if (!valid_symbol(symbol) || !valid_interval(interval)) {
+            std::cerr << "Error: Not registering partition '" << symbol << "' '" << interval
+                      << "': symbols are A-Z/0-9 and intervals 1s through 1M." << std::endl;
+            return false;
+        }
+        sqlite3_stmt* stmt;
+        bool ok = false;
+        if (sqlite3_prepare_v2(db_, "INSERT OR IGNORE INTO partitions (symbol, interval, path) VALUES (?, ?, ?);", -1, &stmt, 0) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, symbol.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, interval.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, path.c_str(), -1, SQLITE_TRANSIENT);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        sqlite3_finalize(stmt);
+        return ok;
+    }
+
+    // True once register_partition() has added symbol/interval
+    bool registered(const std::string& symbol, const std::string& interval) const {
+        for (const auto& partition : partitions()) {
+            if (partition.symbol == symbol && partition.interval == interval) return true;
+        }
+        return false;
+    }
+
+    std::vector<PartitionInfo> partitions() const {
+        std::vector<PartitionInfo> result;
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db_, "SELECT symbol, interval, path FROM partitions ORDER BY symbol, interval;", -1, &stmt, 0) == SQLITE_OK) {
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                PartitionInfo info;
+                info.symbol   = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+                info.interval = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+                info.path     = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+                result.push_back(info);
+            }
+        }
+        sqlite3_finalize(stmt);
+        return result;
+    }
+
+    // A connection with every existing partition ATTACHed and a TEMP VIEW all_klines that
+    // unions them with symbol/interval columns. SQLite caps attachments (10 by default), so only the
+    // first partitions up to that limit are visible; a warning names how many were left out. The
+    // caller closes the connection.
+    sqlite3* open_unified_reader() const {
+        sqlite3* reader = nullptr;
+        if (sqlite3_open(":memory:", &reader) != SQLITE_OK) {
+            sqlite3_close(reader);
+            return nullptr;
+        }
+        register_pi_cycle_functions(reader);
+        int max_attached = sqlite3_limit(reader, SQLITE_LIMIT_ATTACHED, -1);
+        std::string view_sql;
+        int attached = 0;
+        int skipped = 0;
+        for (const auto& partition : partitions()) {
+            struct stat st;
+            if (stat(partition.path.c_str(), &st) != 0) continue;
+            if (attached >= max_attached) {
+                ++skipped;
+                continue;
+            }
+            std::string alias = "p" + std::to_string(attached);
+            sqlite3_stmt* stmt;
+            if (sqlite3_prepare_v2(reader, ("ATTACH DATABASE ? AS " + alias + ";").c_str(), -1, &stmt, 0) == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, partition.path.c_str(), -1, SQLITE_TRANSIENT);
+                if (sqlite3_step(stmt) == SQLITE_DONE) {
+                    // %Q quotes the names as SQL literals, so a catalog entry cannot break the view
+                    char* select_sql = sqlite3_mprintf("SELECT %Q AS symbol, %Q AS interval, * FROM %s.klines",
+                                                       partition.symbol.c_str(), partition.interval.c_str(), alias.c_str());
+                    view_sql += (view_sql.empty() ? "" : " UNION ALL ") + std::string(select_sql);
+                    sqlite3_free(select_sql);
+                    ++attached;
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+        if (skipped > 0) {
+            std::cerr << "Warning: " << skipped << " partitions left out; SQLite attaches at most "
+                      << max_attached << " databases." << std::endl;
+        }
+        if (!view_sql.empty()) {
+            exec_sql(reader, "CREATE TEMP VIEW all_klines AS " + view_sql + ";", "open_unified_reader");
+        }
+        return reader;
+    }
+
+private:
+    sqlite3* db_ = nullptr;
+};
+
+void print_partitions(const KlineCatalog& catalog);
+
+// --- Series Loading ---
+
+KlineColumns fetch_data(const std::string& db_path);
+
+// --- Gap Detection ---
+//
+// A skipped run or a failed request leaves holes in the open_time sequence, and every 365-row
+// window that spans a hole then covers more than 365 days. The scanner walks the open_time primary
+// key in order (no table rows are read) and reports each run of missing candles, which are then
+// fetched with startTime-bounded requests instead of re-downloading the history.
+
+struct KlineGap {
+    long long first_missing; // open_time of the first missing candle
+    long long last_missing;  // open_time of the last missing candle
+    long long missing;       // Number of missing candles
+};
+
+// Holes between the first and last stored candle, plus (with include_tail) the candles between the
+// last stored one and the one in progress now.
+std::vector<KlineGap> find_kline_gaps(sqlite3* db, long long step_ms, bool include_tail);
+std::string format_open_time(long long open_time_ms, long long step_ms);
+
+// --- Materialized Pi Cycle Table ---
+
+// Brings pi_cycle up to date: every row from pi_cycle_state.dirty_from onward is recomputed from the
+// klines it depends on and rewritten, and the mark is cleared, all in one transaction. Closed days
+// before the mark are never touched. Returns the number of rows written, or -1 on error.
+int refresh_pi_cycle(sqlite3* db, bool force_full);
+
+// One pi_cycle row from a statement selecting open_time, price, ma_365, std_365, ceiling, median,
+// floor, step, change, move, offset, weeks_52 in that order
+PiCycleData read_pi_cycle_row(sqlite3_stmt* stmt);
+
+// The newest `limit` rows of pi_cycle, newest first, in a single descending range read of the key.
+std::vector<PiCycleData> load_pi_cycle_latest(sqlite3* db, int limit);
+
+#endif // BINANCE_KLINES_STORE_HPP
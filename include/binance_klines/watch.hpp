@@ -0,0 +1,25 @@
+// Watch mode: the live-updating table
+#ifndef BINANCE_KLINES_WATCH_HPP
+#define BINANCE_KLINES_WATCH_HPP
+
+#include <csignal>
+
+// --- Watch Mode ---
+//
+// --watch keeps the process alive and polls the newest klines over one kept-alive connection.
+// LivePiCycle holds the running sums of the closed prices in the newest row's window, so a price tick
+// updates that row's indicators in O(1). The sums are rebuilt only when a new row opens. The screen is
+// redrawn in place with ANSI cursor addressing: only cells whose text changed are rewritten, in one
+// write() per tick, and nothing forks a shell to clear the terminal.
+
+extern volatile std::sig_atomic_t g_stop_requested; // Set by SIGINT/SIGTERM in the long-running modes
+
+void install_stop_handlers();
+
+// Shows the newest num_display_days rows and keeps the top one live until Ctrl-C. Every
+// `interval_seconds` the klines from the live row onward are fetched; a newer kline closes the live row
+// and scrolls the table down by one. With live_quotes the top row follows the merged venue price, and the
+// venue tickers are asked at most once per max(quote_ttl, interval_seconds).
+int run_watch(int num_display_days, double interval_seconds, bool live_quotes, double quote_ttl);
+
+#endif // BINANCE_KLINES_WATCH_HPP
@@ -0,0 +1,567 @@
+#include "binance_klines/bench.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/formats.hpp"
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/render.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+// For the /dev/null sink and the partition directory (POSIX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Benchmarks ---
+/*----------------------------------------------------------------------------------------------------*/
+std::vector<Kline> make_synthetic_klines(int count, long long first_open_time) {
+    std::vector<Kline> klines(count);
+    double price = 10000.0;
+    for (int i = 0; i < count; ++i) {
+        price *= 1.0 + 0.02 * std::sin(i * 0.37);
+        klines[i].open_time  = first_open_time + (long long)i * 86400000LL;
+        klines[i].open       = std::llround(price * 100.0); // 0.01 ticks
+        klines[i].high       = std::llround(price * 1.01 * 100.0);
+        klines[i].low        = std::llround(price * 0.99 * 100.0);
+        klines[i].close      = std::llround(price * 1.002 * 100.0);
+        klines[i].volume     = 1000.0 + i;
+        klines[i].num_trades = 5000 + i;
+        klines[i].close_time = klines[i].open_time + 86400000LL - 1;
+        klines[i].quote_volume           = klines[i].volume * price;
+        klines[i].taker_buy_base_volume  = klines[i].volume * 0.5;
+        klines[i].taker_buy_quote_volume = klines[i].quote_volume * 0.5;
+        klines[i].price      = (klines[i].high + klines[i].low + 1) / 2;
+    }
+    return klines;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Compares the legacy text-keyed table against the current WITHOUT ROWID layout on a scratch
+// database: a cold upsert of every row, a warm upsert where every row conflicts, and an ordered
+// full scan.
+void run_storage_benchmark(int rows) {
+    const std::string bench_path = "bench-storage.db";
+    std::vector<Kline> klines = make_synthetic_klines(rows, 1262304000000LL); // 2010-01-01
+
+    std::cout << "Storage benchmark: " << rows << " rows" << std::endl;
+    std::cout << "+---------+-------------+-------------+-------------+" << std::endl;
+    std::cout << "| Schema  | Upsert (ms) | Update (ms) |  Scan (ms)  |" << std::endl;
+    std::cout << "+---------+-------------+-------------+-------------+" << std::endl;
+
+    const int layout_versions[] = {1, KLINES_SCHEMA_VERSION};
+    for (int version : layout_versions) {
+        std::remove(bench_path.c_str());
+        sqlite3* db = nullptr;
+        if (sqlite3_open(bench_path.c_str(), &db) != SQLITE_OK) {
+            std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_close(db);
+            return;
+        }
+
+        std::string upsert_sql;
+        std::string scan_sql;
+        if (version == 1) {
+            exec_sql(db, R"(
+                CREATE TABLE klines (dt1 DATE, price REAL, open REAL, high REAL, low REAL,
+                                     close REAL, volume REAL, num_trades INTEGER, UNIQUE (dt1));
+            )", "run_storage_benchmark");
+            upsert_sql = R"(
+                INSERT INTO klines (dt1, price, open, high, low, close, volume, num_trades)
+                VALUES (date(? / 1000, 'unixepoch'), ?, ?, ?, ?, ?, ?, ?)
+                ON CONFLICT(dt1) DO UPDATE SET
+                    price = excluded.price, open = excluded.open, high = excluded.high, low = excluded.low,
+                    close = excluded.close, volume = excluded.volume, num_trades = excluded.num_trades;
+            )";
+            scan_sql = "SELECT dt1, price FROM klines ORDER BY dt1 ASC;";
+        } else {
+            exec_sql(db, klines_table_sql("klines"), "run_storage_benchmark");
+            upsert_sql = KLINES_UPSERT_SQL;
+            scan_sql = "SELECT open_time, price FROM klines ORDER BY open_time ASC;";
+        }
+
+        double upsert_ms[2] = {0.0, 0.0};
+        for (int pass = 0; pass < 2; ++pass) {
+            auto start = std::chrono::steady_clock::now();
+            sqlite3_stmt* stmt;
+            sqlite3_prepare_v2(db, upsert_sql.c_str(), -1, &stmt, 0);
+            exec_sql(db, "BEGIN TRANSACTION;", "run_storage_benchmark");
+            for (const auto& kline : klines) {
+                // The legacy statement has 8 parameters; binding past the end is a harmless SQLITE_RANGE
+                bind_kline(stmt, kline);
+                sqlite3_step(stmt);
+                sqlite3_reset(stmt);
+            }
+            sqlite3_finalize(stmt);
+            exec_sql(db, "END TRANSACTION;", "run_storage_benchmark");
+            upsert_ms[pass] = elapsed_ms(start);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(db, scan_sql.c_str(), -1, &stmt, 0);
+        double checksum = 0.0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            checksum += sqlite3_column_double(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+        double scan_ms = elapsed_ms(start);
+
+        sqlite3_close(db);
+        std::remove(bench_path.c_str());
+
+        std::cout << "| " << std::setw(7) << std::left << ("v" + std::to_string(version)) << std::right << std::fixed << std::setprecision(2)
+                  << " | " << std::setw(11) << upsert_ms[0]
+                  << " | " << std::setw(11) << upsert_ms[1]
+                  << " | " << std::setw(11) << scan_ms << " |" << std::endl;
+        if (g_debug_enabled) {
+            std::cout << "Debug: Scan checksum " << checksum << std::endl;
+        }
+    }
+    std::cout << "+---------+-------------+-------------+-------------+" << std::endl;
+
+    // Polling: the fetcher re-sends the newest 500 candles and usually only the live one moved
+    std::remove(bench_path.c_str());
+    sqlite3* db = nullptr;
+    if (sqlite3_open(bench_path.c_str(), &db) == SQLITE_OK) {
+        create_klines_table(db);
+        insert_klines_data(db, klines);
+
+        std::vector<Kline> poll(klines.end() - std::min(rows, 500), klines.end());
+        poll.back().close += 100; // +1.00
+        poll.back().num_trades += 1;
+
+        auto start = std::chrono::steady_clock::now();
+        UpsertStats stats = insert_klines_data(db, poll);
+        double poll_ms = elapsed_ms(start);
+
+        std::cout << "Polling upsert of " << poll.size() << " candles (1 changed): " << std::fixed << std::setprecision(2)
+                  << poll_ms << " ms - " << stats.inserted << " inserted, " << stats.updated << " updated, "
+                  << stats.skipped << " skipped" << std::endl;
+    }
+    sqlite3_close(db);
+    std::remove(bench_path.c_str());
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Time to get the full price series into memory from binance.db through fetch_data() versus mapping
+// the same series from a columnar file. Each iteration includes opening the source and touching
+// every price so neither side gets away with lazy loading.
+void run_load_benchmark(int iterations) {
+    const std::string bench_path = "bench-load.bkc";
+    std::remove(bench_path.c_str());
+    if (!convert_db_to_columnar(g_db_path, bench_path)) return;
+
+    double checksum = 0.0;
+    size_t rows = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        KlineColumns klines = fetch_data(g_db_path);
+        PriceSeriesView view = price_series_view(klines);
+        for (size_t i = 0; i < view.size; ++i) checksum += view.price[i];
+        rows = view.size;
+    }
+    double sqlite_ms = elapsed_ms(start) / iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        ColumnarFile file;
+        ColumnarSeries mapped;
+        if (!file.open(bench_path) || !file.find(g_symbol, g_interval, mapped)) break;
+        PriceSeriesView view = price_series_view(mapped);
+        for (size_t i = 0; i < view.size; ++i) checksum -= view.price[i];
+    }
+    double mmap_ms = elapsed_ms(start) / iterations;
+    std::remove(bench_path.c_str());
+
+    std::cout << "Load benchmark: " << rows << " rows, " << iterations << " iterations" << std::endl;
+    std::cout << "+----------+-------------+----------------+" << std::endl;
+    std::cout << "| Backend  |  Load (ms)  |    Rows/s      |" << std::endl;
+    std::cout << "+----------+-------------+----------------+" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "| SQLite   | " << std::setw(11) << sqlite_ms << " | " << std::setw(14) << std::setprecision(0) << (sqlite_ms > 0 ? rows / (sqlite_ms / 1000.0) : 0.0) << " |" << std::endl;
+    std::cout << std::setprecision(3);
+    std::cout << "| mmap     | " << std::setw(11) << mmap_ms << " | " << std::setw(14) << std::setprecision(0) << (mmap_ms > 0 ? rows / (mmap_ms / 1000.0) : 0.0) << " |" << std::endl;
+    std::cout << "+----------+-------------+----------------+" << std::endl;
+    if (g_debug_enabled) {
+        std::cout << "Debug: Checksum residue " << checksum << std::endl;
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Ingest rate versus writer threads: `symbols` synthetic symbols of `rows` candles each are upserted
+// into their own scratch partitions, once per thread count. Every partition has its own write lock,
+// so the rate should scale until the disk or fsync cost becomes the bottleneck.
+void run_ingest_benchmark(int symbols, int rows) {
+    const std::string bench_dir = "bench-ingest";
+    std::vector<std::vector<Kline>> series;
+    for (int s = 0; s < symbols; ++s) {
+        series.push_back(make_synthetic_klines(rows, 1262304000000LL + s * 3600000LL));
+    }
+
+    std::cout << "Ingest benchmark: " << symbols << " partitions x " << rows << " rows" << std::endl;
+    std::cout << "+---------+-------------+----------------+---------+" << std::endl;
+    std::cout << "| Threads |  Time (ms)  |    Rows/s      | Speedup |" << std::endl;
+    std::cout << "+---------+-------------+----------------+---------+" << std::endl;
+
+    mkdir(bench_dir.c_str(), 0755);
+    double baseline_ms = 0.0;
+    const int thread_counts[] = {1, 2, 4, 8};
+    for (int threads : thread_counts) {
+        std::vector<std::string> paths;
+        for (int s = 0; s < symbols; ++s) {
+            paths.push_back(bench_dir + "/SYN" + std::to_string(s) + "-1d.db");
+            for (const char* suffix : {"", "-wal", "-shm"}) std::remove((paths.back() + suffix).c_str());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        run_parallel(paths.size(), threads, [&](size_t i) {
+            KlineStore store;
+            if (store.open(paths[i])) insert_klines_data(store.db(), series[i]);
+        });
+        double ms = elapsed_ms(start);
+        if (threads == 1) baseline_ms = ms;
+
+        std::cout << "| " << std::setw(7) << threads << std::fixed << std::setprecision(2)
+                  << " | " << std::setw(11) << ms
+                  << " | " << std::setw(14) << std::setprecision(0) << (ms > 0 ? (double)symbols * rows / (ms / 1000.0) : 0.0)
+                  << " | " << std::setw(6) << std::setprecision(2) << (ms > 0 ? baseline_ms / ms : 0.0) << "x |" << std::endl;
+
+        for (const auto& path : paths) {
+            for (const char* suffix : {"", "-wal", "-shm"}) std::remove((path + suffix).c_str());
+        }
+    }
+    rmdir(bench_dir.c_str());
+    std::cout << "+---------+-------------+----------------+---------+" << std::endl;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The Pi Cycle bands over a synthetic daily series in an in-memory KlineStore, three ways: the native
+// window functions, the same bands spelled with SQLite's built-in AVG() windows (mean of x and of x^2),
+// and price_projection() as the reference the other two are checked against.
+void run_window_benchmark(int rows) {
+    const char* native_sql = R"(
+        SELECT pi_ceiling(price) OVER w, pi_median(price) OVER w, rolling_std(price) OVER w
+        FROM klines WINDOW w AS (ORDER BY open_time ROWS 364 PRECEDING);
+    )";
+    const char* builtin_sql = R"(
+        SELECT mean + 2 * SQRT(MAX(mean_sq - mean * mean, 0)), mean + SQRT(MAX(mean_sq - mean * mean, 0)),
+               SQRT(MAX(mean_sq - mean * mean, 0))
+        FROM (SELECT AVG(price) OVER w AS mean, AVG(price * price) OVER w AS mean_sq
+              FROM klines WINDOW w AS (ORDER BY open_time ROWS 364 PRECEDING));
+    )";
+
+    KlineStore store;
+    if (!store.open(":memory:")) return;
+    store_price_decimals(store.db(), 2); // make_synthetic_klines() uses 0.01 ticks
+    insert_klines_data(store.db(), make_synthetic_klines(rows, 1262304000000LL));
+
+    KlineColumns klines = load_kline_columns(store.db(), KLINE_OPEN_TIME | KLINE_PRICE);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PiCycleData> reference = price_projection(price_series_view(klines));
+    double reference_ms = elapsed_ms(start);
+    const double factor = price_factor(store.db());
+
+    std::cout << "Window function benchmark: " << rows << " rows, 365-row frame" << std::endl;
+    std::cout << "+----------------------+-------------+----------------+---------------+" << std::endl;
+    std::cout << "| Method               |  Time (ms)  |     Rows/s     | Max |ceil err| |" << std::endl;
+    std::cout << "+----------------------+-------------+----------------+---------------+" << std::endl;
+    const char* labels[2] = {"Native functions", "Built-in AVG() SQL"};
+    const char* queries[2] = {native_sql, builtin_sql};
+    for (int q = 0; q < 2; ++q) {
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(store.db(), queries[q], -1, &stmt, 0) != SQLITE_OK) {
+            std::cout << "| " << std::setw(20) << std::left << labels[q] << std::right << " | "
+                      << std::setw(54) << std::left << sqlite3_errmsg(store.db()) << std::right << " |" << std::endl;
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        double max_error = 0.0;
+        for (size_t i = 0; sqlite3_step(stmt) == SQLITE_ROW; ++i) {
+            double ceiling = sqlite3_column_double(stmt, 0) / factor;
+            if (i >= PI_CYCLE_LOOKBACK_ROWS && i < reference.size()) {
+                max_error = std::max(max_error, std::fabs(ceiling - reference[i].ceiling));
+            }
+        }
+        sqlite3_finalize(stmt);
+        double ms = elapsed_ms(start);
+        std::cout << "| " << std::setw(20) << std::left << labels[q] << std::right << std::fixed << std::setprecision(2)
+                  << " | " << std::setw(11) << ms
+                  << " | " << std::setw(14) << std::setprecision(0) << (ms > 0 ? rows / (ms / 1000.0) : 0.0)
+                  << " | " << std::setw(13) << std::scientific << std::setprecision(2) << max_error << " |" << std::endl;
+        std::cout << std::defaultfloat;
+    }
+    std::cout << "| " << std::setw(20) << std::left << "price_projection()" << std::right << std::fixed << std::setprecision(2)
+              << " | " << std::setw(11) << reference_ms
+              << " | " << std::setw(14) << std::setprecision(0) << (reference_ms > 0 ? rows / (reference_ms / 1000.0) : 0.0)
+              << " | " << std::setw(13) << "reference" << " |" << std::endl;
+    std::cout << "+----------------------+-------------+----------------+---------------+" << std::endl;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Minute candles shaped like the Binance feed (0.01 price tick, 5-decimal volume) for when the
+// current partition does not hold enough rows to be representative
+KlineColumns make_synthetic_minute_klines(size_t count) {
+    KlineColumns klines;
+    klines.columns = KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME;
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> returns(0.0, 0.0008);
+    std::exponential_distribution<double> volumes(1.0 / 12.0);
+    double close = 30000.0;
+    for (size_t i = 0; i < count; ++i) {
+        double open = close;
+        close = std::round(open * (1.0 + returns(rng)) * 100.0) / 100.0;
+        double high = std::round(std::max(open, close) * (1.0 + std::fabs(returns(rng)) / 4.0) * 100.0) / 100.0;
+        double low = std::round(std::min(open, close) * (1.0 - std::fabs(returns(rng)) / 4.0) * 100.0) / 100.0;
+        klines.open_time.push_back(1672531200000LL + (long long)i * 60000LL); // 2023-01-01
+        klines.open.push_back(open);
+        klines.high.push_back(high);
+        klines.low.push_back(low);
+        klines.close.push_back(close);
+        klines.volume.push_back(std::round(volumes(rng) * 1e5) / 1e5);
+        klines.price.push_back(std::round(((high + low) / 2.0) * 100.0) / 100.0);
+    }
+    klines.size = count;
+    return klines;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// True when `blocks` decode back to open_time and all six value columns of `klines`, bit for bit
+bool blocks_round_trip(const std::vector<uint8_t>& blocks, const KlineColumns& klines, DecodedKlineBlock& block) {
+    const std::vector<double>* columns[COMPRESSED_VALUE_COLUMNS] = {
+        &klines.price, &klines.open, &klines.high, &klines.low, &klines.close, &klines.volume
+    };
+    size_t row = 0;
+    for (size_t position = 0; position < blocks.size();) {
+        size_t length = decode_kline_block(blocks.data() + position, blocks.size() - position, block);
+        if (length == 0 || row + block.size > klines.size
+            || std::memcmp(block.open_time, klines.open_time.data() + row, block.size * 8) != 0) {
+            return false;
+        }
+        for (int c = 0; c < COMPRESSED_VALUE_COLUMNS; ++c) {
+            if (std::memcmp(block.values[c], columns[c]->data() + row, block.size * 8) != 0) return false;
+        }
+        row += block.size;
+        position += length;
+    }
+    return row == klines.size;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Compression ratio and encode/decode throughput of the block format on the current partition
+// (--symbol/--interval; BTCUSDT 1m is the intended input), or on a synthetic minute series if the
+// partition holds less than one full block.
+void run_compression_benchmark() {
+    const unsigned mask = KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME;
+    KlineColumns klines;
+    std::string source = g_symbol + " " + g_interval;
+    {
+        KlineStore store;
+        if (store.open(g_db_path)) klines = load_kline_columns(store.db(), mask);
+    }
+    // Migrated rows may lack OHLCV; the format needs every column
+    bool complete = klines.size >= COMPRESSED_BLOCK_ROWS;
+    for (size_t i = 0; complete && i < klines.size; ++i) {
+        complete = !std::isnan(klines.volume[i]);
+    }
+    if (!complete) {
+        source = "synthetic 1m (" + source + " has " + std::to_string(klines.size) + " usable rows)";
+        klines = make_synthetic_minute_klines(525600);
+    }
+
+    const double raw_bytes = (double)klines.size * (1 + COMPRESSED_VALUE_COLUMNS) * 8;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> blocks = encode_kline_blocks(klines);
+    double encode_ms = elapsed_ms(start);
+
+    // Feed prices and volumes are decimals and take the fixed-point path. Thirds of the same values
+    // have no short decimal form, so a few blocks of them check the Gorilla XOR path as well.
+    std::unique_ptr<DecodedKlineBlock> block(new DecodedKlineBlock);
+    KlineColumns non_decimal;
+    non_decimal.columns = klines.columns;
+    non_decimal.size = std::min(klines.size, 4 * COMPRESSED_BLOCK_ROWS);
+    for (size_t i = 0; i < non_decimal.size; ++i) {
+        non_decimal.open_time.push_back(klines.open_time[i]);
+        non_decimal.price.push_back(klines.price[i] / 3.0);
+        non_decimal.open.push_back(klines.open[i] / 3.0);
+        non_decimal.high.push_back(klines.high[i] / 3.0);
+        non_decimal.low.push_back(klines.low[i] / 3.0);
+        non_decimal.close.push_back(klines.close[i] / 3.0);
+        non_decimal.volume.push_back(klines.volume[i] / 3.0);
+    }
+    bool exact = blocks_round_trip(blocks, klines, *block)
+              && blocks_round_trip(encode_kline_blocks(non_decimal), non_decimal, *block);
+
+    // Decode every block repeatedly, touching the output so the work is not optimized away
+
+    int iterations = 0;
+    double checksum = 0.0;
+    start = std::chrono::steady_clock::now();
+    do {
+        for (size_t position = 0; position < blocks.size();) {
+            position += decode_kline_block(blocks.data() + position, blocks.size() - position, *block);
+            checksum += block->values[4][block->size - 1];
+        }
+        ++iterations;
+    } while (elapsed_ms(start) < 500.0);
+    double decode_ms = elapsed_ms(start) / iterations;
+
+    std::cout << "Compression benchmark: " << klines.size << " rows, " << source << std::endl;
+    std::cout << "+--------------------------+----------------+" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "| Raw columns (MB)         | " << std::setw(14) << raw_bytes / 1e6 << " |" << std::endl;
+    std::cout << "| Compressed (MB)          | " << std::setw(14) << blocks.size() / 1e6 << " |" << std::endl;
+    std::cout << "| Compression ratio        | " << std::setw(13) << raw_bytes / blocks.size() << "x |" << std::endl;
+    std::cout << "| Bytes per row            | " << std::setw(14) << (double)blocks.size() / klines.size << " |" << std::endl;
+    std::cout << "| Encode (MB/s)            | " << std::setw(14) << raw_bytes / 1e6 / (encode_ms / 1000.0) << " |" << std::endl;
+    std::cout << "| Decode (GB/s)            | " << std::setw(14) << raw_bytes / 1e9 / (decode_ms / 1000.0) << " |" << std::endl;
+    std::cout << "| Lossless round trip      | " << std::setw(14) << (exact ? "yes" : "NO") << " |" << std::endl;
+    std::cout << "+--------------------------+----------------+" << std::endl;
+    if (g_debug_enabled) {
+        std::cout << "Debug: Decode checksum " << checksum << " over " << iterations << " iterations" << std::endl;
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Writes `lines` log lines ending in std::endl to /dev/null through a line-flushed sink (what a
+// plain std::cout does when redirected and flushed per line) and through buffered sinks, counting the
+// syscalls each one makes.
+void run_output_benchmark(int lines) {
+    int fd = ::open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Can't open /dev/null: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    struct Mode {
+        const char* name;
+        size_t      capacity;
+        bool        flush_on_sync;
+    };
+    const Mode modes[] = {
+        {"endl flushes", OUTPUT_BUFFER_SIZE, true},
+        {"64 KiB sink",  64 * 1024,          false},
+        {"1 MiB sink",   OUTPUT_BUFFER_SIZE, false}
+    };
+
+    std::cout << "Output benchmark: " << lines << " lines to /dev/null" << std::endl;
+    std::cout << "+--------------+------------+------------+-------------+" << std::endl;
+    std::cout << "| Mode         |  Syscalls  |  Bytes/op  |  Time (ms)  |" << std::endl;
+    std::cout << "+--------------+------------+------------+-------------+" << std::endl;
+    for (const Mode& mode : modes) {
+        OutputSink sink(fd, mode.capacity, mode.flush_on_sync);
+        std::ostream out(&sink);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lines; ++i) {
+            out << "Debug: Upserted kline " << i << " open_time " << 1262304000000LL + (long long)i * 86400000LL
+                << " price " << 10000 + i % 977 << std::endl;
+        }
+        sink.flush();
+        double ms = elapsed_ms(start);
+        OutputStats stats = sink.stats();
+        unsigned long long syscalls = stats.write_calls + stats.writev_calls;
+        std::cout << "| " << std::setw(12) << std::left << mode.name << std::right
+                  << " | " << std::setw(10) << syscalls
+                  << " | " << std::setw(10) << (syscalls ? stats.bytes / syscalls : 0)
+                  << " | " << std::setw(11) << std::fixed << std::setprecision(2) << ms << " |" << std::endl;
+    }
+    std::cout << "+--------------+------------+------------+-------------+" << std::endl;
+    ::close(fd);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Export throughput of SeriesWriter to /dev/null in every --format, next to a naive exporter that
+// prints each field with snprintf("%.17g"). The rows cycle through the bands of a synthetic daily
+// series past its lookback, so every field is a computed value without a short decimal form.
+void run_export_benchmark(int rows) {
+    int fd = ::open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Can't open /dev/null: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    std::vector<Kline> synthetic = make_synthetic_klines(100000 + PI_CYCLE_LOOKBACK_ROWS, 1262304000000LL);
+    std::vector<long long> open_time(synthetic.size());
+    std::vector<double> price(synthetic.size());
+    for (size_t i = 0; i < synthetic.size(); ++i) {
+        open_time[i] = synthetic[i].open_time;
+        price[i] = synthetic[i].price / 100.0; // 0.01 ticks
+    }
+    PriceSeriesView view;
+    view.open_time = open_time.data();
+    view.price = price.data();
+    view.size = synthetic.size();
+    std::vector<PiCycleData> bands = price_projection(view);
+    bands.erase(bands.begin(), bands.begin() + std::min(bands.size(), (size_t)PI_CYCLE_LOOKBACK_ROWS));
+    if (bands.empty()) return;
+
+    const size_t flush_bytes = 1 << 20; // Hand the buffer to write() per MiB, like the output sink
+    const char* labels[4] = {"csv", "json", "ndjson", "csv via %.17g"};
+    const SeriesFormat formats[3] = {SERIES_CSV, SERIES_JSON, SERIES_NDJSON};
+
+    std::cout << "Export benchmark: " << rows << " rows to /dev/null" << std::endl;
+    std::cout << "+---------------+-------------+----------------+------------+" << std::endl;
+    std::cout << "| Format        |  Time (ms)  |     Rows/s     |    MB/s    |" << std::endl;
+    std::cout << "+---------------+-------------+----------------+------------+" << std::endl;
+    for (int f = 0; f < 4; ++f) {
+        std::string buffer;
+        buffer.reserve(flush_bytes + 4096);
+        unsigned long long bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (f < 3) {
+            SeriesWriter writer(formats[f], &buffer);
+            writer.begin();
+            for (int i = 0; i < rows; ++i) {
+                writer.row(bands[(size_t)i % bands.size()]);
+                if (buffer.size() >= flush_bytes) {
+                    write_all(fd, buffer.data(), buffer.size());
+                    bytes += buffer.size();
+                    buffer.clear();
+                }
+            }
+            writer.end();
+        } else {
+            char line[1024];
+            for (int i = 0; i < rows; ++i) {
+                const PiCycleData& data = bands[(size_t)i % bands.size()];
+                char* out = line;
+                format_ymd(epoch_day(data.open_time), out);
+                out += DATE_BUFFER_SIZE - 1;
+                out += std::snprintf(out, 24, ",%lld", data.open_time);
+                for (const SeriesField& field : SERIES_FIELDS) {
+                    out += std::snprintf(out, 32, ",%.17g", data.*field.member);
+                }
+                *out++ = '\n';
+                buffer.append(line, (size_t)(out - line));
+                if (buffer.size() >= flush_bytes) {
+                    write_all(fd, buffer.data(), buffer.size());
+                    bytes += buffer.size();
+                    buffer.clear();
+                }
+            }
+        }
+        write_all(fd, buffer.data(), buffer.size());
+        bytes += buffer.size();
+        double ms = elapsed_ms(start);
+        std::cout << "| " << std::setw(13) << std::left << labels[f] << std::right << std::fixed << std::setprecision(2)
+                  << " | " << std::setw(11) << ms
+                  << " | " << std::setw(14) << std::setprecision(0) << (ms > 0 ? rows / (ms / 1000.0) : 0.0)
+                  << " | " << std::setw(10) << std::setprecision(1) << (ms > 0 ? bytes / (ms * 1000.0) : 0.0) << " |" << std::endl;
+    }
+    std::cout << "+---------------+-------------+----------------+------------+" << std::endl;
+    ::close(fd);
+}
@@ -0,0 +1,49 @@
+#include "binance_klines/common.hpp"
+
+#include <string>
+#include <chrono>
+
+// --- Global Constants ---
+const std::string BASE_URL = "https://api.binance.us"; // Or https://api.binance.com for global
+const std::string DB_PATH = "binance.db";
+const std::string GEMINI_API_URL = "https://api.gemini.com/v1/pubticker/"; // + pair, e.g. btcusd
+const std::string CATALOG_PATH = "catalog.db"; // (symbol, interval) -> partition database
+const std::string PARTITION_DIR = "klines";     // Default home of partitions other than binance.db
+
+// --- Global Variables ---
+bool g_debug_enabled = false; // Global flag for debug output
+std::string g_symbol   = "BTCUSDT";
+std::string g_interval = "1d";
+std::string g_db_path  = DB_PATH; // Partition of g_symbol/g_interval, resolved through the catalog
+double first_row_yearly_value = 0.00;
+double first_row_avg_price    = 0.00;
+double first_row_step         = 0.00;
+
+// --- Date Utilities ---
+/*----------------------------------------------------------------------------------------------------*/
+std::string format_date(long long open_time_ms) {
+    char buffer[DATE_BUFFER_SIZE];
+    return std::string(format_ymd(epoch_day(open_time_ms), buffer), DATE_BUFFER_SIZE - 1);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Start of the UTC day `days` days before today, in ms since epoch (SQLite's date('now', '-N days'))
+long long trailing_days_cutoff_ms(int days) {
+    return epoch_day_to_ms(current_epoch_day() - days);
+}
+
+// --- Intervals ---
+/*----------------------------------------------------------------------------------------------------*/
+// Open time of the candle in progress now; weekly candles open on Monday, four days after the epoch
+long long current_open_time(long long step_ms) {
+    const long long anchor = step_ms == 7 * MS_PER_DAY ? 4 * MS_PER_DAY : 0;
+    long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    return (now_ms - anchor) / step_ms * step_ms + anchor;
+}
+
+// --- Timing ---
+/*----------------------------------------------------------------------------------------------------*/
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
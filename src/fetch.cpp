@@ -0,0 +1,406 @@
+#include "binance_klines/fetch.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/store.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+
+// For stat(), mkdir() and unlink() on partition files (POSIX)
+#include <sys/stat.h>
+#include <unistd.h>
+
+// For HTTP requests (libcurl)
+#include <curl/curl.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- HTTP Helpers ---
+/*----------------------------------------------------------------------------------------------------*/
+size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
+    size_t newLength = size * nmemb;
+    try {
+        s->append((char*)contents, newLength);
+    } catch (std::bad_alloc &e) {
+        std::cerr << "Memory allocation error in cURL callback: " << e.what() << std::endl;
+        return 0;
+    }
+    return newLength;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// GET `url` into `body` over `curl`, which keeps its connection alive between calls. Pending output
+// is flushed first, since the request may block.
+bool http_get(CURL* curl, const std::string& url, std::string& body) {
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L); // WARNING: For testing, disable in production
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L); // WARNING: For testing, disable in production
+
+    flush_output(); // Show what is pending before blocking on the network
+    CURLcode res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Binance REST API ---
+/*----------------------------------------------------------------------------------------------------*/
+// Price decimals of `symbol` from the PRICE_FILTER tickSize in exchangeInfo, or -1 on failure.
+int fetch_price_decimals(const std::string& symbol) {
+    int decimals = -1;
+    std::string readBuffer;
+    CURL* curl = curl_easy_init();
+    if (!curl) return decimals;
+
+    if (http_get(curl, BASE_URL + "/api/v3/exchangeInfo?symbol=" + symbol, readBuffer)) {
+        decimals = parse_exchange_info_decimals(readBuffer, symbol);
+    }
+    curl_easy_cleanup(curl);
+    return decimals;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The partition's price decimals, asking the exchange and recording the answer the first time.
+// Returns -1 when no scale is recorded and the exchange could not be reached.
+int ensure_price_decimals(sqlite3* db, const std::string& symbol) {
+    int decimals = stored_price_decimals(db);
+    if (decimals >= 0) return decimals;
+    decimals = fetch_price_decimals(symbol);
+    if (decimals < 0 || !store_price_decimals(db, decimals)) return -1;
+    return stored_price_decimals(db);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// curl_global_init() is not thread-safe, so main() calls it once before any fetch runs. Without a
+// start_time the exchange returns the latest `limit` candles; end_time (inclusive) is optional.
+// Prices are parsed into ticks of 10^-price_decimals; a price off that grid fails the whole batch.
+std::vector<Kline> get_klines_from_binance(const std::string& symbol, const std::string& interval, int price_decimals,
+                                           long long start_time, long long end_time, int limit, CURL* session,
+                                           bool* off_grid) {
+    std::vector<Kline> klines_data;
+    std::string readBuffer;
+    CURL* curl = session ? session : curl_easy_init(); // A caller's session keeps its connection alive between calls
+    if (!curl) return klines_data;
+
+    std::string url = BASE_URL + "/api/v3/klines?symbol=" + symbol + "&interval=" + interval + "&limit=" + std::to_string(limit);
+    if (start_time > 0) url += "&startTime=" + std::to_string(start_time);
+    if (end_time > 0) url += "&endTime=" + std::to_string(end_time);
+    if (http_get(curl, url, readBuffer)) {
+        klines_data = parse_klines(readBuffer, symbol, price_decimals, off_grid);
+    }
+    if (!session) curl_easy_cleanup(curl);
+    return klines_data;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// get_klines_from_binance() on the partition's tick grid. A batch off the recorded grid means the
+// exchange's tick got finer (or the recorded scale was never right), so exchangeInfo is asked again,
+// the partition is rescaled to the new tick and the request is retried once.
+std::vector<Kline> fetch_partition_klines(sqlite3* db, const std::string& symbol, const std::string& interval,
+                                          long long start_time = 0, long long end_time = 0, int limit = 500) {
+    int decimals = ensure_price_decimals(db, symbol);
+    if (decimals < 0) return std::vector<Kline>();
+
+    bool off_grid = false;
+    std::vector<Kline> klines = get_klines_from_binance(symbol, interval, decimals, start_time, end_time, limit,
+                                                        nullptr, &off_grid);
+    if (off_grid) {
+        int exchange_decimals = fetch_price_decimals(symbol);
+        if (exchange_decimals > decimals && rescale_prices(db, exchange_decimals)) {
+            klines = get_klines_from_binance(symbol, interval, exchange_decimals, start_time, end_time, limit);
+        }
+    }
+    return klines;
+}
+
+// --- Partition Updates ---
+/*----------------------------------------------------------------------------------------------------*/
+// Upserts the latest candles of `symbol` into the partition at `db_path` and returns how many were
+// fetched. A failed fetch is reported and leaves the partition as it was (0); -1 means the partition
+// cannot be opened. When the exchange's tick got finer than the recorded scale, the partition is
+// rescaled first.
+long long update_partition(const std::string& db_path, const std::string& symbol, const std::string& interval) {
+    KlineStore store;
+    if (!store.open(db_path)) {
+        return -1;
+    }
+
+    std::vector<Kline> klines_from_api = fetch_partition_klines(store.db(), symbol, interval);
+    if (!klines_from_api.empty()) {
+        insert_klines_data(store.db(), klines_from_api);
+        update_current_date_price_with_close(store.db());
+    } else {
+        std::cerr << "No klines data fetched. Skipping database operations." << std::endl;
+    }
+
+    if (g_debug_enabled && interval_ms(interval) > 0) {
+        long long missing = 0;
+        for (const auto& gap : find_kline_gaps(store.db(), interval_ms(interval), false)) missing += gap.missing;
+        if (missing > 0) {
+            std::cout << "Debug: " << missing << " candles missing between stored ones; run --fill-gaps to fetch them." << std::endl;
+        }
+    }
+    return (long long)klines_from_api.size();
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Registers a partition once a fetch has filled it. A first fetch that failed (a mistyped symbol,
+// say) removes the file it created instead, so it leaves neither a catalog entry nor an empty file.
+bool settle_partition(KlineCatalog& catalog, const std::string& symbol, const std::string& interval,
+                      const std::string& path, bool existed, long long fetched) {
+    if (fetched > 0) return catalog.register_partition(symbol, interval, path);
+    if (!existed && !catalog.registered(symbol, interval)) {
+        for (const char* suffix : {"", "-wal", "-shm"}) unlink((path + suffix).c_str());
+    }
+    return catalog.registered(symbol, interval);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// update_partition() for the catalogued partition of symbol/interval, registering it on the first
+// successful fetch. Returns false when there is no partition to read afterwards.
+bool update_catalog_partition(KlineCatalog& catalog, const std::string& symbol, const std::string& interval) {
+    if (!valid_symbol(symbol) || !valid_interval(interval)) {
+        std::cerr << "Error: Invalid symbol '" << symbol << "' or interval '" << interval
+                  << "'; symbols are A-Z/0-9 and intervals 1s through 1M." << std::endl;
+        return false;
+    }
+    const std::string path = catalog.partition_path(symbol, interval);
+    struct stat st;
+    const bool existed = stat(path.c_str(), &st) == 0;
+    mkdir(PARTITION_DIR.c_str(), 0755);
+    long long fetched = update_partition(path, symbol, interval);
+    if (fetched < 0) return false;
+    if (!settle_partition(catalog, symbol, interval, path, existed, fetched)) {
+        std::cerr << "Error: No " << symbol << " " << interval << " klines fetched; the partition is not registered." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Fetches and upserts each symbol into its own partition, one writer per thread.
+void backfill_symbols(KlineCatalog& catalog, const std::vector<std::string>& requested, const std::string& interval, int threads) {
+    if (!valid_interval(interval)) {
+        std::cerr << "Error: Invalid interval '" << interval << "'; intervals are 1s through 1M." << std::endl;
+        return;
+    }
+    std::vector<std::string> symbols;
+    std::vector<std::string> paths;
+    std::vector<char> existed;
+    for (const auto& symbol : requested) {
+        if (!valid_symbol(symbol)) {
+            std::cerr << "Error: Skipping invalid symbol '" << symbol << "'; symbols are A-Z/0-9." << std::endl;
+            continue;
+        }
+        struct stat st;
+        symbols.push_back(symbol);
+        paths.push_back(catalog.partition_path(symbol, interval));
+        existed.push_back(stat(paths.back().c_str(), &st) == 0);
+    }
+    mkdir(PARTITION_DIR.c_str(), 0755);
+
+    std::mutex log_mutex;
+    std::vector<long long> fetched(symbols.size(), 0);
+    run_parallel(symbols.size(), threads, [&](size_t i) {
+        std::vector<Kline> klines;
+        KlineStore store;
+        UpsertStats stats;
+        if (store.open(paths[i])) {
+            klines = fetch_partition_klines(store.db(), symbols[i], interval);
+            fetched[i] = (long long)klines.size();
+        }
+        if (!klines.empty()) {
+            stats = insert_klines_data(store.db(), klines);
+            update_current_date_price_with_close(store.db());
+        }
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cout << std::setw(10) << std::left << symbols[i] << std::right << " " << interval << ": "
+                  << klines.size() << " fetched, " << stats.inserted << " inserted, " << stats.updated
+                  << " updated, " << stats.skipped << " skipped -> " << paths[i] << std::endl;
+    });
+
+    // Registered from this thread only, once every writer has closed its partition
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        settle_partition(catalog, symbols[i], interval, paths[i], existed[i] != 0, fetched[i]);
+    }
+}
+
+// --- Gemini Ticker ---
+/*----------------------------------------------------------------------------------------------------*/
+// Bid, ask and last trade of a Gemini pair ("btcusd"); all zero on failure
+Ticker gemini_get_bid_ask_last(const std::string& pair, CURL* session) {
+    Ticker ticker = {0.0, 0.0, 0.0};
+    std::string readBuffer;
+    CURL* curl = session ? session : curl_easy_init(); // A caller's session keeps its connection alive between calls
+    if (!curl) return ticker;
+
+    if (http_get(curl, GEMINI_API_URL + pair, readBuffer)) {
+        parse_gemini_ticker(readBuffer, ticker);
+    }
+    if (!session) curl_easy_cleanup(curl);
+    return ticker;
+}
+
+// --- Gap Filling ---
+/*----------------------------------------------------------------------------------------------------*/
+// Fetches the candles of each gap page by page (1000 per request) and upserts them. Returns the
+// number of candles inserted.
+long long fill_kline_gaps(sqlite3* db, const std::string& symbol, const std::string& interval,
+                          const std::vector<KlineGap>& gaps) {
+    const int PAGE_LIMIT = 1000;
+    const long long step_ms = interval_ms(interval);
+    long long inserted = 0;
+    for (const auto& gap : gaps) {
+        for (long long start = gap.first_missing; start <= gap.last_missing;) {
+            std::vector<Kline> page = fetch_partition_klines(db, symbol, interval, start, gap.last_missing, PAGE_LIMIT);
+            if (page.empty()) break; // Request failed, or the exchange has no candles here (e.g. a trading halt)
+            inserted += insert_klines_data(db, page).inserted;
+            start = page.back().open_time + step_ms;
+        }
+    }
+    if (inserted > 0) update_current_date_price_with_close(db);
+    return inserted;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Scans every catalogued partition for gaps and prints a report. With `fill`, the missing ranges
+// are fetched first (partitions in parallel) and the report shows what was recovered and what is
+// still missing afterwards.
+void report_kline_gaps(KlineCatalog& catalog, bool fill, int threads) {
+    struct PartitionGaps {
+        PartitionInfo         partition;
+        std::vector<KlineGap> gaps;
+        long long             refetched = 0;
+        std::vector<KlineGap> remaining;
+    };
+    std::vector<PartitionGaps> results;
+    for (const auto& partition : catalog.partitions()) {
+        struct stat st;
+        if (interval_ms(partition.interval) == 0 || stat(partition.path.c_str(), &st) != 0) continue;
+        PartitionGaps result;
+        result.partition = partition;
+        results.push_back(result);
+    }
+
+    run_parallel(results.size(), fill ? threads : 1, [&](size_t i) {
+        PartitionGaps& result = results[i];
+        const long long step_ms = interval_ms(result.partition.interval);
+        KlineStore store;
+        if (!store.open(result.partition.path)) return;
+        result.gaps = find_kline_gaps(store.db(), step_ms, true);
+        if (fill && !result.gaps.empty()) {
+            result.refetched = fill_kline_gaps(store.db(), result.partition.symbol, result.partition.interval, result.gaps);
+            result.remaining = find_kline_gaps(store.db(), step_ms, true);
+        } else {
+            result.remaining = result.gaps;
+        }
+    });
+
+    std::cout << "+------------+----------+------------------+------------------+----------+-----------+" << std::endl;
+    std::cout << "| Symbol     | Interval |   First Missing  |   Last Missing   | Missing  | Remaining |" << std::endl;
+    std::cout << "+------------+----------+------------------+------------------+----------+-----------+" << std::endl;
+    long long total_missing = 0;
+    long long total_remaining = 0;
+    long long total_refetched = 0;
+    for (const auto& result : results) {
+        const long long step_ms = interval_ms(result.partition.interval);
+        for (const auto& gap : result.gaps) {
+            long long remaining = 0;
+            for (const auto& left : result.remaining) {
+                long long from = std::max(left.first_missing, gap.first_missing);
+                long long to = std::min(left.last_missing, gap.last_missing);
+                if (from <= to) remaining += (to - from) / step_ms + 1;
+            }
+            std::cout << "| " << std::setw(10) << std::left << result.partition.symbol
+                      << " | " << std::setw(8) << result.partition.interval
+                      << " | " << std::setw(16) << format_open_time(gap.first_missing, step_ms)
+                      << " | " << std::setw(16) << format_open_time(gap.last_missing, step_ms) << std::right
+                      << " | " << std::setw(8) << gap.missing
+                      << " | " << std::setw(9) << remaining << " |" << std::endl;
+            total_missing += gap.missing;
+            total_remaining += remaining;
+        }
+        total_refetched += result.refetched;
+    }
+    std::cout << "+------------+----------+------------------+------------------+----------+-----------+" << std::endl;
+    std::cout << "Partitions scanned: " << results.size() << ", missing candles: " << total_missing;
+    if (fill) {
+        std::cout << ", refetched: " << total_refetched << ", still missing: " << total_remaining;
+    }
+    std::cout << std::endl;
+}
+
+// --- Live Quotes ---
+/*----------------------------------------------------------------------------------------------------*/
+// Bid, ask and last trade of a Binance symbol from its 24-hour ticker; all zero on failure
+Ticker binance_get_bid_ask_last(const std::string& symbol, CURL* session) {
+    Ticker ticker = {0.0, 0.0, 0.0};
+    std::string readBuffer;
+    CURL* curl = session ? session : curl_easy_init();
+    if (!curl) return ticker;
+
+    if (http_get(curl, BASE_URL + "/api/v3/ticker/24hr?symbol=" + symbol, readBuffer)) {
+        parse_binance_ticker(readBuffer, ticker);
+    }
+    if (!session) curl_easy_cleanup(curl);
+    return ticker;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Gemini pair of a USD-quoted Binance symbol ("BTCUSDT" -> "btcusd"), or "" when there is none.
+// Stablecoin quotes map to the USD pair, so the spread includes the stablecoin's own premium.
+std::string gemini_pair(const std::string& symbol) {
+    static const char* const USD_QUOTES[] = {"USDT", "USDC", "BUSD", "USD"};
+    for (const char* quote : USD_QUOTES) {
+        const size_t length = std::strlen(quote);
+        if (symbol.size() > length && symbol.compare(symbol.size() - length, length, quote) == 0) {
+            std::string pair = symbol.substr(0, symbol.size() - length) + "usd";
+            std::transform(pair.begin(), pair.end(), pair.begin(), ::tolower);
+            return pair;
+        }
+    }
+    return "";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Binance's last trade as the newest row's price, plus the best bid and ask across venues and the
+// spread between their last prices; without a Binance last `price` stays 0
+MergedQuote merge_quotes(const std::vector<VenueQuote>& quotes) {
+    MergedQuote merged;
+    std::vector<double> lasts;
+    for (const auto& quote : quotes) {
+        const Ticker& ticker = quote.ticker;
+        if (!(ticker.last > 0)) continue;
+        lasts.push_back(ticker.last);
+        if (ticker.bid > 0 && (!merged.bid_venue || ticker.bid > merged.best_bid)) {
+            merged.best_bid = ticker.bid;
+            merged.bid_venue = quote.venue;
+        }
+        if (ticker.ask > 0 && (!merged.ask_venue || ticker.ask < merged.best_ask)) {
+            merged.best_ask = ticker.ask;
+            merged.ask_venue = quote.venue;
+        }
+    }
+    if (lasts.empty()) return merged;
+
+    const auto range = std::minmax_element(lasts.begin(), lasts.end());
+    merged.venues = (int)lasts.size();
+    if (quotes.size() > QUOTE_BINANCE && quotes[QUOTE_BINANCE].ticker.last > 0) {
+        merged.price = quotes[QUOTE_BINANCE].ticker.last;
+    }
+    merged.spread = *range.second - *range.first;
+    merged.spread_pct = merged.price > 0 ? merged.spread / merged.price * 100.0 : 0.0;
+    return merged;
+}
@@ -0,0 +1,929 @@
+#include "binance_klines/formats.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/store.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+// For the memory-mapped columnar backend and the block files (POSIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Columnar File Backend ---
+const uint32_t COLUMNAR_FORMAT_VERSION   = 1;
+
+/*----------------------------------------------------------------------------------------------------*/
+// Appends one symbol/interval segment. `klines` must hold the open_time, price and OHLCV columns.
+bool append_columnar_segment(const std::string& path, const std::string& symbol, const std::string& interval,
+                             const KlineColumns& klines) {
+    const unsigned required = KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME;
+    if ((klines.columns & required) != required) {
+        std::cerr << "Error: append_columnar_segment needs open_time, price and OHLCV columns." << std::endl;
+        return false;
+    }
+
+    // Carry the existing index forward, minus any entry this segment supersedes
+    std::vector<ColumnarFooterEntry> entries;
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0 && st.st_size > 0) {
+            ColumnarFile existing;
+            if (!existing.open(path)) return false;
+            for (const auto& entry : existing.entries()) {
+                if (symbol != std::string(entry.symbol, strnlen(entry.symbol, sizeof(entry.symbol)))
+                    || interval != std::string(entry.interval, strnlen(entry.interval, sizeof(entry.interval)))) {
+                    entries.push_back(entry);
+                }
+            }
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Can't open columnar file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    off_t offset = lseek(fd, 0, SEEK_END);
+
+    bool ok = true;
+    if (offset == 0) {
+        char header[COLUMNAR_HEADER_SIZE] = {0};
+        std::memcpy(header, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+        std::memcpy(header + 8, &COLUMNAR_FORMAT_VERSION, sizeof(uint32_t));
+        std::memcpy(header + 12, &COLUMNAR_HEADER_SIZE, sizeof(uint32_t));
+        ok = write_all(fd, header, sizeof(header));
+        offset = COLUMNAR_HEADER_SIZE;
+    }
+
+    ColumnarFooterEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    // Fixed-width name fields: NUL-padded, but not NUL-terminated when the name fills the field
+    std::memcpy(entry.symbol, symbol.data(), std::min(symbol.size(), sizeof(entry.symbol)));
+    std::memcpy(entry.interval, interval.data(), std::min(interval.size(), sizeof(entry.interval)));
+    entry.row_count       = klines.size;
+    entry.first_open_time = klines.size ? klines.open_time.front() : 0;
+    entry.last_open_time  = klines.size ? klines.open_time.back() : 0;
+
+    const void* columns[COLUMNAR_COLUMN_COUNT] = {
+        klines.open_time.data(), klines.price.data(), klines.open.data(), klines.high.data(),
+        klines.low.data(), klines.close.data(), klines.volume.data()
+    };
+    for (int c = 0; ok && c < COLUMNAR_COLUMN_COUNT; ++c) {
+        entry.column_offsets[c] = (uint64_t)offset;
+        ok = write_all(fd, columns[c], klines.size * 8);
+        offset += (off_t)(klines.size * 8);
+    }
+    entries.push_back(entry);
+
+    uint64_t entry_count = entries.size();
+    uint64_t footer_offset = (uint64_t)offset;
+    ok = ok && write_all(fd, &entry_count, sizeof(entry_count))
+            && write_all(fd, entries.data(), entries.size() * sizeof(ColumnarFooterEntry))
+            && write_all(fd, &footer_offset, sizeof(footer_offset))
+            && write_all(fd, COLUMNAR_TRAILER_MAGIC, sizeof(COLUMNAR_TRAILER_MAGIC))
+            && fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok) {
+        std::cerr << "Error: Failed to append to columnar file " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    return ok;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool convert_db_to_columnar(const std::string& db_path, const std::string& out_path) {
+    sqlite3* db;
+    if (sqlite3_open(db_path.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Error: Can't open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    KlineColumns klines = load_kline_columns(db, KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH
+                                                 | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME);
+    sqlite3_close(db);
+
+    if (!append_columnar_segment(out_path, g_symbol, g_interval, klines)) return false;
+    std::cout << "Wrote " << klines.size << " " << g_symbol << " " << g_interval << " klines to " << out_path << "." << std::endl;
+    return true;
+}
+
+// --- Compressed Block Format ---
+
+const char   COMPRESSED_MAGIC[8]        = {'B', 'K', 'Z', 'B', 'L', 'K', '0', '1'};
+
+/*----------------------------------------------------------------------------------------------------*/
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void write(uint64_t value, unsigned bits) {
+        if (bits > 32) {
+            write(value >> 32, bits - 32);
+            bits = 32;
+        }
+        if (bits == 0) return;
+        acc_ = (acc_ << bits) | (value & ((1ULL << bits) - 1));
+        count_ += bits;
+        while (count_ >= 8) {
+            count_ -= 8;
+            out_.push_back((uint8_t)(acc_ >> count_));
+        }
+    }
+
+    void flush() {
+        if (count_ > 0) out_.push_back((uint8_t)(acc_ << (8 - count_)));
+        count_ = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t              acc_   = 0;
+    unsigned              count_ = 0;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// Reads past the end return zero bits; the block length bounds every read the decoder makes.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+    uint64_t read(unsigned bits) {
+        if (bits > 32) {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+        if (bits == 0) return 0;
+        while (count_ < bits) {
+            acc_ = (acc_ << 8) | (p_ < end_ ? *p_++ : 0);
+            count_ += 8;
+        }
+        count_ -= bits;
+        return (acc_ >> count_) & ((1ULL << bits) - 1);
+    }
+
+    bool bit() { return read(1) != 0; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t       acc_   = 0;
+    unsigned       count_ = 0;
+};
+
+inline uint64_t zigzag_encode(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t  zigzag_decode(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+inline unsigned bit_width(uint64_t v) {
+    unsigned width = 0;
+    while (v) {
+        ++width;
+        v >>= 1;
+    }
+    return width;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Smallest decimal count that represents every value exactly, or -1 if none does
+int fixed_point_decimals(const double* values, size_t n) {
+    for (int d = 0; d <= COMPRESSED_MAX_DECIMALS; ++d) {
+        const double scale = DECIMAL_SCALES[d];
+        bool exact = true;
+        for (size_t i = 0; i < n && exact; ++i) {
+            double scaled = values[i] * scale;
+            exact = std::isfinite(scaled) && std::fabs(scaled) < 9.0e15
+                 && (double)std::llround(scaled) / scale == values[i];
+        }
+        if (exact) return d;
+    }
+    return -1;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void encode_gorilla_xor(BitWriter& bits, const double* values, size_t n) {
+    uint64_t previous;
+    std::memcpy(&previous, &values[0], sizeof(previous));
+    bits.write(previous, 64);
+    int previous_leading = -1;
+    int previous_trailing = 0;
+    for (size_t i = 1; i < n; ++i) {
+        uint64_t current;
+        std::memcpy(&current, &values[i], sizeof(current));
+        uint64_t x = current ^ previous;
+        previous = current;
+        if (x == 0) {
+            bits.write(0, 1);
+            continue;
+        }
+        int leading = std::min(__builtin_clzll(x), 31);
+        int trailing = __builtin_ctzll(x);
+        if (previous_leading >= 0 && leading >= previous_leading && trailing >= previous_trailing) {
+            // Meaningful bits fit in the previous window
+            bits.write(0x2, 2);
+            bits.write(x >> previous_trailing, 64 - previous_leading - previous_trailing);
+        } else {
+            int meaningful = 64 - leading - trailing;
+            bits.write(0x3, 2);
+            bits.write((uint64_t)leading, 5);
+            bits.write((uint64_t)(meaningful & 63), 6); // 64 is stored as 0
+            bits.write(x >> trailing, (unsigned)meaningful);
+            previous_leading = leading;
+            previous_trailing = trailing;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// False when a control code describes a window past bit 64, which only a corrupt block contains
+bool decode_gorilla_xor(BitReader& bits, double* values, size_t n) {
+    uint64_t previous = bits.read(64);
+    std::memcpy(&values[0], &previous, sizeof(previous));
+    int leading = 0;
+    int meaningful = 64;
+    for (size_t i = 1; i < n; ++i) {
+        if (bits.bit()) {
+            if (bits.bit()) {
+                leading = (int)bits.read(5);
+                meaningful = (int)bits.read(6);
+                if (meaningful == 0) meaningful = 64;
+                if (leading + meaningful > 64) return false;
+            }
+            previous ^= bits.read((unsigned)meaningful) << (64 - leading - meaningful);
+        }
+        std::memcpy(&values[i], &previous, sizeof(previous));
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Appends one block holding rows [begin, end) of `klines` (open_time, price and OHLCV columns)
+void encode_kline_block(const KlineColumns& klines, size_t begin, size_t end, std::vector<uint8_t>& out) {
+    const size_t n = end - begin;
+    const size_t start = out.size();
+    uint32_t header[2] = {0, (uint32_t)n};
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(header), reinterpret_cast<const uint8_t*>(header) + sizeof(header));
+
+    BitWriter bits(out);
+    const long long* open_time = klines.open_time.data() + begin;
+    bits.write((uint64_t)open_time[0], 64);
+    int64_t previous_delta = 0;
+    for (size_t i = 1; i < n; ++i) {
+        int64_t delta = open_time[i] - open_time[i - 1];
+        uint64_t dod = zigzag_encode(delta - previous_delta);
+        previous_delta = delta;
+        if (dod == 0)                 bits.write(0, 1);
+        else if (dod < (1ULL << 7))   { bits.write(0x2, 2);    bits.write(dod, 7); }
+        else if (dod < (1ULL << 9))   { bits.write(0x6, 3);   bits.write(dod, 9); }
+        else if (dod < (1ULL << 12))  { bits.write(0xE, 4);  bits.write(dod, 12); }
+        else if (dod < (1ULL << 32))  { bits.write(0x1E, 5); bits.write(dod, 32); }
+        else                          { bits.write(0x1F, 5); bits.write(dod, 64); }
+    }
+
+    const std::vector<double>* columns[COMPRESSED_VALUE_COLUMNS] = {
+        &klines.price, &klines.open, &klines.high, &klines.low, &klines.close, &klines.volume
+    };
+    for (int c = 0; c < COMPRESSED_VALUE_COLUMNS; ++c) {
+        const double* values = columns[c]->data() + begin;
+        int decimals = fixed_point_decimals(values, n);
+        if (decimals < 0) {
+            bits.write(1, 1);
+            encode_gorilla_xor(bits, values, n);
+            continue;
+        }
+        const double scale = DECIMAL_SCALES[decimals];
+        uint64_t max_delta = 0;
+        for (size_t i = 1; i < n; ++i) {
+            max_delta |= zigzag_encode(std::llround(values[i] * scale) - std::llround(values[i - 1] * scale));
+        }
+        unsigned width = bit_width(max_delta);
+        bits.write(0, 1);
+        bits.write((uint64_t)decimals, 4);
+        bits.write(width, 7);
+        long long previous = std::llround(values[0] * scale);
+        bits.write((uint64_t)previous, 64);
+        for (size_t i = 1; i < n; ++i) {
+            long long current = std::llround(values[i] * scale);
+            bits.write(zigzag_encode(current - previous), width);
+            previous = current;
+        }
+    }
+    bits.flush();
+
+    uint32_t length = (uint32_t)(out.size() - start);
+    std::memcpy(&out[start], &length, sizeof(length));
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Decodes the block at `data` (at most `size` bytes available). Returns the block's byte length,
+// or 0 if the block is malformed.
+size_t decode_kline_block(const uint8_t* data, size_t size, DecodedKlineBlock& block) {
+    uint32_t header[2];
+    if (size < sizeof(header)) return 0;
+    std::memcpy(header, data, sizeof(header));
+    const size_t length = header[0];
+    const size_t n = header[1];
+    if (length < sizeof(header) || length > size || n == 0 || n > COMPRESSED_BLOCK_ROWS) return 0;
+
+    // Sums are taken in uint64_t, so the deltas of a corrupt block wrap instead of overflowing
+    BitReader bits(data + sizeof(header), length - sizeof(header));
+    int64_t* open_time = block.open_time;
+    uint64_t time = bits.read(64);
+    uint64_t delta = 0;
+    open_time[0] = (int64_t)time;
+    for (size_t i = 1; i < n; ++i) {
+        if (bits.bit()) {
+            unsigned width;
+            if (!bits.bit())      width = 7;
+            else if (!bits.bit()) width = 9;
+            else if (!bits.bit()) width = 12;
+            else if (!bits.bit()) width = 32;
+            else                  width = 64;
+            delta += (uint64_t)zigzag_decode(bits.read(width));
+        }
+        time += delta;
+        open_time[i] = (int64_t)time;
+    }
+
+    for (int c = 0; c < COMPRESSED_VALUE_COLUMNS; ++c) {
+        double* values = block.values[c];
+        if (bits.bit()) {
+            if (!decode_gorilla_xor(bits, values, n)) return 0;
+            continue;
+        }
+        int decimals = (int)bits.read(4);
+        unsigned width = (unsigned)bits.read(7);
+        if (decimals > COMPRESSED_MAX_DECIMALS || width > 64) return 0;
+        const double scale = DECIMAL_SCALES[decimals];
+        uint64_t current = bits.read(64);
+        values[0] = (double)(int64_t)current / scale;
+        for (size_t i = 1; i < n; ++i) {
+            current += (uint64_t)zigzag_decode(bits.read(width));
+            values[i] = (double)(int64_t)current / scale;
+        }
+    }
+    block.size = n;
+    return length;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+std::vector<uint8_t> encode_kline_blocks(const KlineColumns& klines) {
+    std::vector<uint8_t> out;
+    for (size_t begin = 0; begin < klines.size; begin += COMPRESSED_BLOCK_ROWS) {
+        encode_kline_block(klines, begin, std::min(klines.size, begin + COMPRESSED_BLOCK_ROWS), out);
+    }
+    return out;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Streams the blocks of a compressed file, mapped read-only, one decoded block at a time
+class CompressedBlockReader {
+public:
+    CompressedBlockReader() {}
+    ~CompressedBlockReader() { close(); }
+    CompressedBlockReader(const CompressedBlockReader&) = delete;
+    CompressedBlockReader& operator=(const CompressedBlockReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Can't open compressed file " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(COMPRESSED_MAGIC)) {
+            std::cerr << "Error: Compressed file " << path << " is truncated." << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            std::cerr << "Error: mmap failed for " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(base);
+        size_ = (size_t)st.st_size;
+        if (std::memcmp(data_, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC)) != 0) {
+            std::cerr << "Error: " << path << " is not a compressed kline file." << std::endl;
+            close();
+            return false;
+        }
+        position_ = sizeof(COMPRESSED_MAGIC);
+        return true;
+    }
+
+    void close() {
+        if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        position_ = 0;
+    }
+
+    // False at the end of the file or on a malformed block
+    bool next(DecodedKlineBlock& block) {
+        if (position_ >= size_) return false;
+        size_t length = decode_kline_block(data_ + position_, size_ - position_, block);
+        if (length == 0) {
+            std::cerr << "Error: Corrupt compressed block at offset " << position_ << "." << std::endl;
+            position_ = size_;
+            return false;
+        }
+        position_ += length;
+        return true;
+    }
+
+private:
+    const uint8_t* data_     = nullptr;
+    size_t         size_     = 0;
+    size_t         position_ = 0;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// Decodes a whole compressed file into open_time, price and OHLCV columns
+bool load_compressed_series(const std::string& path, KlineColumns& klines) {
+    CompressedBlockReader reader;
+    if (!reader.open(path)) return false;
+    klines = KlineColumns();
+    klines.columns = KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME;
+    std::vector<double>* columns[COMPRESSED_VALUE_COLUMNS] = {
+        &klines.price, &klines.open, &klines.high, &klines.low, &klines.close, &klines.volume
+    };
+    std::unique_ptr<DecodedKlineBlock> block(new DecodedKlineBlock);
+    while (reader.next(*block)) {
+        klines.open_time.insert(klines.open_time.end(), block->open_time, block->open_time + block->size);
+        for (int c = 0; c < COMPRESSED_VALUE_COLUMNS; ++c) {
+            columns[c]->insert(columns[c]->end(), block->values[c], block->values[c] + block->size);
+        }
+        klines.size += block->size;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool convert_db_to_compressed(const std::string& db_path, const std::string& out_path) {
+    sqlite3* db;
+    if (sqlite3_open(db_path.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Error: Can't open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    KlineColumns klines = load_kline_columns(db, KLINE_OPEN_TIME | KLINE_PRICE | KLINE_OPEN | KLINE_HIGH
+                                                 | KLINE_LOW | KLINE_CLOSE | KLINE_VOLUME);
+    sqlite3_close(db);
+
+    std::vector<uint8_t> blocks = encode_kline_blocks(klines);
+    int fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0
+           && write_all(fd, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC))
+           && write_all(fd, blocks.data(), blocks.size())
+           && fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (!ok) {
+        std::cerr << "Error: Failed to write compressed file " << out_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << klines.size << " " << g_symbol << " " << g_interval << " klines to " << out_path
+              << " (" << blocks.size() + sizeof(COMPRESSED_MAGIC) << " bytes)." << std::endl;
+    return true;
+}
+
+// --- Arrow IPC Export ---
+
+/*----------------------------------------------------------------------------------------------------*/
+// Minimal flatbuffers builder. Like the reference implementation it fills the buffer back to front,
+// so children are created before the tables that point at them and every offset points forward.
+class FlatBufferBuilder {
+public:
+    FlatBufferBuilder() : buf_(1024), head_(1024) {}
+
+    uint32_t size() const { return (uint32_t)(buf_.size() - head_); }
+
+    uint32_t create_string(const std::string& s) {
+        align(s.size() + 1, 4);
+        pad(1);
+        push_bytes(s.data(), s.size());
+        push<uint32_t>((uint32_t)s.size());
+        return size();
+    }
+
+    // Vector of `count` inline structs of `struct_size` bytes each
+    uint32_t create_struct_vector(const void* data, size_t count, size_t struct_size, size_t alignment) {
+        align(count * struct_size, 4);
+        align(count * struct_size, alignment);
+        push_bytes(data, count * struct_size);
+        push<uint32_t>((uint32_t)count);
+        return size();
+    }
+
+    uint32_t create_offset_vector(const std::vector<uint32_t>& offsets) {
+        align(offsets.size() * 4, 4);
+        for (size_t i = offsets.size(); i-- > 0;) {
+            push<uint32_t>(size() + 4 - offsets[i]);
+        }
+        push<uint32_t>((uint32_t)offsets.size());
+        return size();
+    }
+
+    void start_table() {
+        fields_.clear();
+        table_start_ = size();
+    }
+
+    template <typename T>
+    void add_scalar(uint16_t field_id, T value) {
+        align(sizeof(T), sizeof(T));
+        push<T>(value);
+        fields_.push_back(std::make_pair(field_id, size()));
+    }
+
+    void add_offset(uint16_t field_id, uint32_t target) {
+        align(4, 4);
+        push<uint32_t>(size() + 4 - target);
+        fields_.push_back(std::make_pair(field_id, size()));
+    }
+
+    uint32_t end_table() {
+        align(4, 4);
+        push<int32_t>(0); // soffset to the vtable, patched below
+        uint32_t table = size();
+
+        uint16_t field_count = 0;
+        for (const auto& field : fields_) field_count = std::max<uint16_t>(field_count, field.first + 1);
+        std::vector<uint16_t> vtable(field_count, 0);
+        for (const auto& field : fields_) vtable[field.first] = (uint16_t)(table - field.second);
+
+        for (size_t i = vtable.size(); i-- > 0;) push<uint16_t>(vtable[i]);
+        push<uint16_t>((uint16_t)(table - table_start_));
+        push<uint16_t>((uint16_t)(4 + 2 * vtable.size()));
+
+        int32_t vtable_distance = (int32_t)(size() - table);
+        std::memcpy(&buf_[buf_.size() - table], &vtable_distance, sizeof(vtable_distance));
+        return table;
+    }
+
+    std::vector<uint8_t> finish(uint32_t root) {
+        align(4, min_align_);
+        push<uint32_t>(size() + 4 - root);
+        return std::vector<uint8_t>(buf_.begin() + head_, buf_.end());
+    }
+
+private:
+    void reserve(size_t bytes) {
+        if (head_ >= bytes) return;
+        size_t used = buf_.size() - head_;
+        size_t capacity = std::max(buf_.size() * 2, used + bytes);
+        std::vector<uint8_t> grown(capacity);
+        std::memcpy(grown.data() + capacity - used, buf_.data() + head_, used);
+        buf_.swap(grown);
+        head_ = capacity - used;
+    }
+
+    void pad(size_t bytes) {
+        reserve(bytes);
+        while (bytes-- > 0) buf_[--head_] = 0;
+    }
+
+    // Pads so that `length` bytes pushed next end on an `alignment` boundary
+    void align(size_t length, size_t alignment) {
+        min_align_ = std::max(min_align_, alignment);
+        pad((alignment - ((size() + length) % alignment)) % alignment);
+    }
+
+    void push_bytes(const void* data, size_t length) {
+        reserve(length);
+        head_ -= length;
+        if (length) std::memcpy(&buf_[head_], data, length);
+    }
+
+    template <typename T>
+    void push(T value) { push_bytes(&value, sizeof(T)); } // Flatbuffers are little-endian, like every target we build for
+
+    std::vector<uint8_t> buf_;
+    size_t head_;
+    size_t min_align_ = 1;
+    uint32_t table_start_ = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> fields_;
+};
+
+// Enum values from the Arrow format's Schema.fbs / Message.fbs
+const int16_t ARROW_METADATA_V5        = 4;
+const uint8_t ARROW_HEADER_SCHEMA      = 1;
+const uint8_t ARROW_HEADER_RECORDBATCH = 3;
+const uint8_t ARROW_TYPE_INT           = 2;
+const uint8_t ARROW_TYPE_FLOATINGPOINT = 3;
+const uint8_t ARROW_TYPE_TIMESTAMP     = 10;
+const int16_t ARROW_PRECISION_DOUBLE   = 2;
+const int16_t ARROW_UNIT_MILLISECOND   = 1;
+const size_t  ARROW_ALIGNMENT          = 64;
+
+enum ArrowColumnType { ARROW_TIMESTAMP_MS, ARROW_INT32, ARROW_FLOAT64, ARROW_PRICE }; // ARROW_PRICE: ticks -> float64
+
+struct ArrowColumn {
+    const char*     name;
+    ArrowColumnType type;
+};
+
+inline size_t arrow_value_width(ArrowColumnType type) { return type == ARROW_INT32 ? 4 : 8; }
+
+// Export columns, in the order of ARROW_EXPORT_QUERY
+const ArrowColumn ARROW_EXPORT_COLUMNS[] = {
+    {"open_time", ARROW_TIMESTAMP_MS}, {"open", ARROW_PRICE}, {"high", ARROW_PRICE}, {"low", ARROW_PRICE},
+    {"close", ARROW_PRICE}, {"volume", ARROW_FLOAT64}, {"num_trades", ARROW_INT32},
+    {"close_time", ARROW_TIMESTAMP_MS}, {"quote_volume", ARROW_FLOAT64}, {"taker_buy_base_volume", ARROW_FLOAT64},
+    {"taker_buy_quote_volume", ARROW_FLOAT64}, {"price", ARROW_PRICE}, {"ma_365", ARROW_FLOAT64},
+    {"std_365", ARROW_FLOAT64}, {"ceiling", ARROW_FLOAT64}, {"median", ARROW_FLOAT64}, {"floor", ARROW_FLOAT64},
+    {"step", ARROW_FLOAT64}, {"change", ARROW_FLOAT64}, {"move", ARROW_FLOAT64}, {"offset", ARROW_FLOAT64},
+    {"weeks_52", ARROW_FLOAT64}
+};
+const size_t ARROW_EXPORT_COLUMN_COUNT = sizeof(ARROW_EXPORT_COLUMNS) / sizeof(ARROW_EXPORT_COLUMNS[0]);
+
+const char* ARROW_EXPORT_QUERY = R"(
+    SELECT k.open_time, k.open, k.high, k.low, k.close, k.volume, k.num_trades,
+           k.close_time, k.quote_volume, k.taker_buy_base_volume, k.taker_buy_quote_volume,
+           k.price, p.ma_365, p.std_365, p.ceiling, p.median, p.floor, p.step, p.change, p.move, p.offset, p.weeks_52
+    FROM klines k
+    LEFT JOIN pi_cycle p ON p.open_time = k.open_time
+    ORDER BY k.open_time ASC;
+)";
+
+struct ArrowBlock {
+    int64_t offset;
+    int32_t metadata_length;
+    int32_t padding;
+    int64_t body_length;
+};
+
+struct ArrowBuffer {
+    int64_t offset;
+    int64_t length;
+};
+
+struct ArrowFieldNode {
+    int64_t length;
+    int64_t null_count;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+uint32_t build_arrow_schema(FlatBufferBuilder& fbb, const std::string& symbol, const std::string& interval) {
+    std::vector<uint32_t> fields;
+    for (size_t c = 0; c < ARROW_EXPORT_COLUMN_COUNT; ++c) {
+        const ArrowColumn& column = ARROW_EXPORT_COLUMNS[c];
+        uint32_t name = fbb.create_string(column.name);
+        uint32_t timezone = column.type == ARROW_TIMESTAMP_MS ? fbb.create_string("UTC") : 0;
+        uint8_t type_type;
+        fbb.start_table();
+        if (column.type == ARROW_TIMESTAMP_MS) {
+            fbb.add_offset(1, timezone);
+            fbb.add_scalar<int16_t>(0, ARROW_UNIT_MILLISECOND);
+            type_type = ARROW_TYPE_TIMESTAMP;
+        } else if (column.type == ARROW_INT32) {
+            fbb.add_scalar<int32_t>(0, 32);   // bitWidth
+            fbb.add_scalar<uint8_t>(1, 1);    // is_signed
+            type_type = ARROW_TYPE_INT;
+        } else {
+            fbb.add_scalar<int16_t>(0, ARROW_PRECISION_DOUBLE);
+            type_type = ARROW_TYPE_FLOATINGPOINT;
+        }
+        uint32_t type = fbb.end_table();
+        uint32_t children = fbb.create_offset_vector(std::vector<uint32_t>());
+
+        fbb.start_table();
+        fbb.add_offset(0, name);
+        fbb.add_offset(3, type);
+        fbb.add_offset(5, children);
+        fbb.add_scalar<uint8_t>(1, 1); // nullable: migrated rows may lack the newer kline fields
+        fbb.add_scalar<uint8_t>(2, type_type);
+        fields.push_back(fbb.end_table());
+    }
+    uint32_t field_vector = fbb.create_offset_vector(fields);
+
+    std::vector<uint32_t> metadata;
+    const std::pair<std::string, std::string> pairs[] = {{"symbol", symbol}, {"interval", interval}};
+    for (const auto& pair : pairs) {
+        uint32_t key = fbb.create_string(pair.first);
+        uint32_t value = fbb.create_string(pair.second);
+        fbb.start_table();
+        fbb.add_offset(0, key);
+        fbb.add_offset(1, value);
+        metadata.push_back(fbb.end_table());
+    }
+    uint32_t metadata_vector = fbb.create_offset_vector(metadata);
+
+    fbb.start_table();
+    fbb.add_offset(1, field_vector);
+    fbb.add_offset(2, metadata_vector);
+    fbb.add_scalar<int16_t>(0, 0); // Little endian
+    return fbb.end_table();
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+std::vector<uint8_t> build_arrow_message(FlatBufferBuilder& fbb, uint8_t header_type, uint32_t header, int64_t body_length) {
+    fbb.start_table();
+    fbb.add_scalar<int64_t>(3, body_length);
+    fbb.add_offset(2, header);
+    fbb.add_scalar<int16_t>(0, ARROW_METADATA_V5);
+    fbb.add_scalar<uint8_t>(1, header_type);
+    return fbb.finish(fbb.end_table());
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Writes the encapsulated message header at `offset` and pads it so the body that follows starts on
+// an ARROW_ALIGNMENT boundary. `block` receives the footer entry; its body length is left at 0.
+bool write_arrow_metadata(int fd, int64_t& offset, const std::vector<uint8_t>& metadata, ArrowBlock& block) {
+    static const char zeros[ARROW_ALIGNMENT] = {0};
+    size_t prefixed = 8 + metadata.size();
+    size_t padding = (ARROW_ALIGNMENT - (offset + prefixed) % ARROW_ALIGNMENT) % ARROW_ALIGNMENT;
+    uint32_t continuation = 0xFFFFFFFF;
+    int32_t metadata_length = (int32_t)(metadata.size() + padding);
+
+    block.offset = offset;
+    block.metadata_length = (int32_t)(prefixed + padding);
+    block.padding = 0;
+    block.body_length = 0;
+    offset += block.metadata_length;
+    return write_all(fd, &continuation, sizeof(continuation))
+        && write_all(fd, &metadata_length, sizeof(metadata_length))
+        && write_all(fd, metadata.data(), metadata.size())
+        && write_all(fd, zeros, padding);
+}
+
+// One export column's buffers for the batch being filled; reused across batches
+struct ArrowColumnBuffer {
+    std::vector<uint8_t> validity;
+    std::vector<uint8_t> values;
+    int64_t              null_count = 0;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// Lays the batch's buffers out in the body and writes the RecordBatch message followed by the body
+bool write_arrow_record_batch(int fd, int64_t& offset, std::vector<ArrowColumnBuffer>& columns, size_t rows,
+                              std::vector<ArrowBlock>& blocks) {
+    static const char zeros[ARROW_ALIGNMENT] = {0};
+    std::vector<ArrowFieldNode> nodes;
+    std::vector<ArrowBuffer> buffers;
+    std::vector<std::pair<const uint8_t*, size_t>> body;
+    int64_t body_length = 0;
+    auto add_buffer = [&](const uint8_t* data, size_t length) {
+        ArrowBuffer buffer = {body_length, (int64_t)length};
+        buffers.push_back(buffer);
+        body.push_back(std::make_pair(data, length));
+        body_length += (int64_t)((length + ARROW_ALIGNMENT - 1) / ARROW_ALIGNMENT * ARROW_ALIGNMENT);
+    };
+    for (size_t c = 0; c < columns.size(); ++c) {
+        ArrowFieldNode node = {(int64_t)rows, columns[c].null_count};
+        nodes.push_back(node);
+        // A column without nulls may omit its validity bitmap
+        add_buffer(columns[c].validity.data(), columns[c].null_count ? (rows + 7) / 8 : 0);
+        add_buffer(columns[c].values.data(), rows * arrow_value_width(ARROW_EXPORT_COLUMNS[c].type));
+    }
+
+    FlatBufferBuilder fbb;
+    uint32_t node_vector = fbb.create_struct_vector(nodes.data(), nodes.size(), sizeof(ArrowFieldNode), 8);
+    uint32_t buffer_vector = fbb.create_struct_vector(buffers.data(), buffers.size(), sizeof(ArrowBuffer), 8);
+    fbb.start_table();
+    fbb.add_scalar<int64_t>(0, (int64_t)rows);
+    fbb.add_offset(1, node_vector);
+    fbb.add_offset(2, buffer_vector);
+    uint32_t record_batch = fbb.end_table();
+
+    ArrowBlock block;
+    if (!write_arrow_metadata(fd, offset, build_arrow_message(fbb, ARROW_HEADER_RECORDBATCH, record_batch, body_length), block)) {
+        return false;
+    }
+    for (const auto& buffer : body) {
+        size_t padding = (ARROW_ALIGNMENT - buffer.second % ARROW_ALIGNMENT) % ARROW_ALIGNMENT;
+        if (!write_all(fd, buffer.first, buffer.second) || !write_all(fd, zeros, padding)) return false;
+    }
+    offset += body_length;
+    block.body_length = body_length;
+    blocks.push_back(block);
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Streams klines + pi_cycle into an Arrow IPC file, `batch_rows` rows per record batch. The caller
+// refreshes pi_cycle first. Returns the number of rows written, or -1 on error.
+long long export_arrow(sqlite3* db, const std::string& path, size_t batch_rows) {
+    const double factor = price_factor(db);
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, ARROW_EXPORT_QUERY, -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Can't open " << path << ": " << std::strerror(errno) << std::endl;
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+
+    const char magic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+    int64_t offset = sizeof(magic);
+    bool ok = write_all(fd, magic, sizeof(magic));
+
+    ArrowBlock schema_block;
+    {
+        FlatBufferBuilder fbb;
+        uint32_t schema = build_arrow_schema(fbb, g_symbol, g_interval);
+        ok = ok && write_arrow_metadata(fd, offset, build_arrow_message(fbb, ARROW_HEADER_SCHEMA, schema, 0), schema_block);
+    }
+
+    std::vector<ArrowColumnBuffer> columns(ARROW_EXPORT_COLUMN_COUNT);
+    for (size_t c = 0; c < columns.size(); ++c) {
+        columns[c].validity.resize((batch_rows + 7) / 8);
+        columns[c].values.resize(batch_rows * arrow_value_width(ARROW_EXPORT_COLUMNS[c].type));
+    }
+
+    std::vector<ArrowBlock> blocks;
+    long long total_rows = 0;
+    size_t rows = 0;
+    int rc = SQLITE_ROW;
+    while (ok && rc == SQLITE_ROW) {
+        rc = sqlite3_step(stmt);
+        if (rc == SQLITE_ROW) {
+            if (rows == 0) {
+                for (auto& column : columns) {
+                    std::fill(column.validity.begin(), column.validity.end(), 0);
+                    column.null_count = 0;
+                }
+            }
+            for (size_t c = 0; c < columns.size(); ++c) {
+                ArrowColumnBuffer& column = columns[c];
+                uint8_t* slot = &column.values[rows * arrow_value_width(ARROW_EXPORT_COLUMNS[c].type)];
+                if (sqlite3_column_type(stmt, (int)c) == SQLITE_NULL) {
+                    ++column.null_count;
+                    std::memset(slot, 0, arrow_value_width(ARROW_EXPORT_COLUMNS[c].type));
+                    continue;
+                }
+                column.validity[rows / 8] |= (uint8_t)(1u << (rows % 8));
+                if (ARROW_EXPORT_COLUMNS[c].type == ARROW_INT32) {
+                    int32_t value = sqlite3_column_int(stmt, (int)c);
+                    std::memcpy(slot, &value, sizeof(value));
+                } else if (ARROW_EXPORT_COLUMNS[c].type == ARROW_TIMESTAMP_MS) {
+                    int64_t value = sqlite3_column_int64(stmt, (int)c);
+                    std::memcpy(slot, &value, sizeof(value));
+                } else if (ARROW_EXPORT_COLUMNS[c].type == ARROW_PRICE) {
+                    double value = sqlite3_column_int64(stmt, (int)c) / factor;
+                    std::memcpy(slot, &value, sizeof(value));
+                } else {
+                    double value = sqlite3_column_double(stmt, (int)c);
+                    std::memcpy(slot, &value, sizeof(value));
+                }
+            }
+            ++rows;
+        } else if (rc != SQLITE_DONE) {
+            std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
+            ok = false;
+        }
+        if (ok && (rows == batch_rows || (rc == SQLITE_DONE && rows > 0))) {
+            ok = write_arrow_record_batch(fd, offset, columns, rows, blocks);
+            total_rows += (long long)rows;
+            rows = 0;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    // End-of-stream marker, then the footer that indexes the schema and every batch
+    const uint32_t end_of_stream[2] = {0xFFFFFFFF, 0};
+    ok = ok && write_all(fd, end_of_stream, sizeof(end_of_stream));
+    if (ok) {
+        FlatBufferBuilder fbb;
+        uint32_t schema = build_arrow_schema(fbb, g_symbol, g_interval);
+        uint32_t dictionaries = fbb.create_struct_vector(nullptr, 0, sizeof(ArrowBlock), 8);
+        uint32_t record_batches = fbb.create_struct_vector(blocks.data(), blocks.size(), sizeof(ArrowBlock), 8);
+        fbb.start_table();
+        fbb.add_offset(1, schema);
+        fbb.add_offset(2, dictionaries);
+        fbb.add_offset(3, record_batches);
+        fbb.add_scalar<int16_t>(0, ARROW_METADATA_V5);
+        std::vector<uint8_t> footer = fbb.finish(fbb.end_table());
+        int32_t footer_length = (int32_t)footer.size();
+        ok = write_all(fd, footer.data(), footer.size())
+          && write_all(fd, &footer_length, sizeof(footer_length))
+          && write_all(fd, magic, 6);
+    }
+    ok = ok && fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok) {
+        std::cerr << "Error: Failed to write Arrow file " << path << "." << std::endl;
+        return -1;
+    }
+    if (g_debug_enabled) {
+        std::cout << "Debug: Wrote " << total_rows << " rows in " << blocks.size() << " record batches to " << path << "." << std::endl;
+    }
+    return total_rows;
+}
@@ -0,0 +1,283 @@
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/formats.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- SQL Window Functions ---
+
+// INTEGER arguments (the tick columns) are summed exactly in 64/128-bit integers, so a frame that
+// slides over years of rows never accumulates error. Once a REAL argument shows up the frame switches
+// to doubles: sums of (x - shift), with shift near the frame mean so the variance does not cancel
+// against mean^2, each with a Neumaier compensation term.
+struct RollingMoments {
+    long long count;
+    bool      real;
+    long long int_sum;
+    __int128  int_sum_sq;
+    double    shift;
+    double    sum, sum_error;
+    double    sum_sq, sum_sq_error;
+};
+
+inline void compensated_add(double& sum, double& error, double x) {
+    double t = sum + x;
+    error += (std::fabs(sum) >= std::fabs(x)) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The frame's state. SQLite only guarantees 8-byte alignment for aggregate context memory and the
+// 128-bit sum needs 16, so the struct sits at the first aligned address inside a padded allocation.
+// Returns nullptr when allocate is false and the frame never saw a row.
+RollingMoments* rolling_moments(sqlite3_context* ctx, bool allocate) {
+    const size_t align = alignof(RollingMoments);
+    void* raw = sqlite3_aggregate_context(ctx, allocate ? (int)(sizeof(RollingMoments) + align) : 0);
+    if (!raw) return nullptr;
+    return reinterpret_cast<RollingMoments*>((reinterpret_cast<uintptr_t>(raw) + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Adds (sign = 1) or removes (sign = -1) one value
+void rolling_moments_update(RollingMoments* m, sqlite3_value* value, int sign) {
+    if (!m->real && sqlite3_value_type(value) == SQLITE_INTEGER) {
+        long long x = sqlite3_value_int64(value);
+        m->count += sign;
+        m->int_sum += sign * x;
+        m->int_sum_sq += sign * (__int128)x * x;
+        return;
+    }
+    if (!m->real) {
+        m->real = true;
+        m->shift = m->count ? (double)m->int_sum / m->count : sqlite3_value_double(value);
+        m->sum = (double)m->int_sum - m->count * m->shift;
+        m->sum_sq = (double)(m->int_sum_sq - (__int128)m->int_sum * m->int_sum / (m->count ? m->count : 1))
+                  + m->sum * m->sum / (m->count ? m->count : 1);
+    }
+    double x = sqlite3_value_double(value) - m->shift;
+    m->count += sign;
+    compensated_add(m->sum, m->sum_error, sign * x);
+    compensated_add(m->sum_sq, m->sum_sq_error, sign * x * x);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void rolling_moments_step(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) return;
+    RollingMoments* m = rolling_moments(ctx, true);
+    if (!m) {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+    rolling_moments_update(m, argv[0], 1);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void rolling_moments_inverse(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) return;
+    RollingMoments* m = rolling_moments(ctx, true);
+    if (!m || m->count == 0) return;
+    if (m->count == 1) {
+        std::memset(m, 0, sizeof(*m)); // An empty frame starts over, back on the exact integer sums
+        return;
+    }
+    rolling_moments_update(m, argv[0], -1);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Mean and population deviation of the current frame; sets a NULL result and returns false if empty.
+bool rolling_moments_stats(sqlite3_context* ctx, double& mean, double& std_dev) {
+    RollingMoments* m = rolling_moments(ctx, false);
+    if (!m || m->count == 0) {
+        sqlite3_result_null(ctx);
+        return false;
+    }
+    const double n = (double)m->count;
+    if (!m->real) {
+        // n^2 * variance = n * sum(x^2) - sum(x)^2, exact in 128 bits
+        __int128 scaled_variance = (__int128)m->count * m->int_sum_sq - (__int128)m->int_sum * m->int_sum;
+        mean = m->int_sum / n;
+        std_dev = std::sqrt((double)scaled_variance) / n;
+        return true;
+    }
+    double shifted_mean = (m->sum + m->sum_error) / n;
+    mean = m->shift + shifted_mean;
+    std_dev = std::sqrt(std::max(0.0, (m->sum_sq + m->sum_sq_error) / n - shifted_mean * shifted_mean));
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void rolling_std_value(sqlite3_context* ctx) {
+    double mean, std_dev;
+    if (rolling_moments_stats(ctx, mean, std_dev)) sqlite3_result_double(ctx, std_dev);
+}
+
+void pi_ceiling_value(sqlite3_context* ctx) {
+    double mean, std_dev;
+    if (rolling_moments_stats(ctx, mean, std_dev)) sqlite3_result_double(ctx, mean + 2 * std_dev);
+}
+
+void pi_median_value(sqlite3_context* ctx) {
+    double mean, std_dev;
+    if (rolling_moments_stats(ctx, mean, std_dev)) sqlite3_result_double(ctx, mean + std_dev); // (ceiling + floor) / 2
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool register_pi_cycle_functions(sqlite3* db) {
+    static const struct { const char* name; void (*value)(sqlite3_context*); } FUNCTIONS[] = {
+        {"rolling_std", rolling_std_value},
+        {"pi_ceiling",  pi_ceiling_value},
+        {"pi_median",   pi_median_value}
+    };
+    for (const auto& function : FUNCTIONS) {
+        // The value callback doubles as xFinal: there is nothing to free, SQLite owns the context
+        if (sqlite3_create_window_function(db, function.name, 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+                                           rolling_moments_step, function.value, function.value,
+                                           rolling_moments_inverse, nullptr) != SQLITE_OK) {
+            std::cerr << "Error: Can't register SQL function " << function.name << ": " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Pi Cycle Calculation ---
+/*----------------------------------------------------------------------------------------------------*/
+PriceSeriesView price_series_view(const KlineColumns& klines) {
+    PriceSeriesView view;
+    view.open_time = klines.open_time.data();
+    view.price     = klines.price.data();
+    view.size      = klines.size;
+    return view;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+PriceSeriesView price_series_view(const ColumnarSeries& series) {
+    PriceSeriesView view;
+    view.open_time = series.open_time;
+    view.price     = series.price;
+    view.size      = series.size;
+    return view;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+std::vector<PiCycleData> price_projection(const PriceSeriesView& klines) {
+    std::vector<PiCycleData> pi_data(klines.size);
+
+    for (size_t i = 0; i < klines.size; ++i) {
+        pi_data[i].open_time = klines.open_time[i];
+        pi_data[i].price = klines.price[i];
+
+        if (i >= 364) { // Need 365 data points for 365-day MA and STD
+            double sum_price = 0.0;
+            for (size_t j = i - 364; j <= i; ++j) {
+                sum_price += klines.price[j];
+            }
+            pi_data[i].ma_365 = sum_price / 365.0;
+
+            double sum_sq_diff = 0.0;
+            for (size_t j = i - 364; j <= i; ++j) {
+                sum_sq_diff += std::pow(klines.price[j] - pi_data[i].ma_365, 2);
+            }
+            pi_data[i].std_365 = std::sqrt(sum_sq_diff / 365.0);
+
+            pi_data[i].ceiling = pi_data[i].ma_365 + (2 * pi_data[i].std_365);
+            pi_data[i].floor = pi_data[i].ma_365;
+            pi_data[i].median = (pi_data[i].ceiling + pi_data[i].floor) / 2.0;
+        }
+    }
+    return pi_data;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+std::vector<PiCycleData> add_calculated_fields(std::vector<PiCycleData> pi_data) {
+    // Calculate daily price changes
+    for (size_t i = 1; i < pi_data.size(); ++i) {
+        pi_data[i].change = pi_data[i].price - pi_data[i-1].price;
+        if (pi_data[i-1].price != 0) {
+            pi_data[i].move = (pi_data[i].price - pi_data[i-1].price) / pi_data[i-1].price * 100.0;
+        }
+    }
+
+    // Calculate dynamic step (simplified: rolling average of daily changes)
+    const int lookback_days_for_step = 364; // Corresponds to 364-day lookback in Python
+    for (size_t i = 0; i < pi_data.size(); ++i) {
+        if (i >= lookback_days_for_step) {
+            double sum_daily_diff = 0.0;
+            for (int j = 0; j < lookback_days_for_step; ++j) {
+                sum_daily_diff += pi_data[i - j].change; // Summing up daily changes
+            }
+            pi_data[i].dynamic_step = sum_daily_diff / lookback_days_for_step;
+        }
+        pi_data[i].step = pi_data[i].dynamic_step;
+    }
+
+    // Calculate Offset - distance from MEDIAN as percentage
+    for (size_t i = 0; i < pi_data.size(); ++i) {
+        if (pi_data[i].median != 0) {
+            pi_data[i].offset = ((pi_data[i].price - pi_data[i].median) / pi_data[i].median) * 100.0;
+        }
+    }
+
+    // Calculate actual 364-day price percentage change (current price vs price 364 days ago)
+    for (size_t i = 0; i < pi_data.size(); ++i) {
+        if (i >= 364) {
+            if (pi_data[i - 364].price != 0) {
+                pi_data[i].weeks_52 = ((pi_data[i].price - pi_data[i - 364].price) / pi_data[i - 364].price) * 100.0;
+            }
+        }
+    }
+
+    return pi_data;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Indicators for just the newest `num_display_days` rows of `series`, newest first. Only those rows
+// and the PI_CYCLE_LOOKBACK_ROWS before them are read; the earlier rows of the window are inputs
+// whose own indicators are never computed.
+std::vector<PiCycleData> compute_display_rows(PriceSeriesView series, int num_display_days) {
+    const size_t window = (size_t)num_display_days + PI_CYCLE_LOOKBACK_ROWS;
+    if (series.size > window) {
+        series.open_time += series.size - window;
+        series.price += series.size - window;
+        series.size = window;
+    }
+    std::vector<PiCycleData> pi_data = add_calculated_fields(price_projection(series));
+
+    std::vector<PiCycleData> pi_data_reversed;
+    if (pi_data.size() > (size_t)num_display_days) {
+        pi_data_reversed.assign(pi_data.end() - num_display_days, pi_data.end());
+    } else {
+        pi_data_reversed = pi_data;
+    }
+    std::reverse(pi_data_reversed.begin(), pi_data_reversed.end());
+    return pi_data_reversed;
+}
+
+// --- Live Row ---
+/*----------------------------------------------------------------------------------------------------*/
+// Recomputes the newest display row at the live `price`. If the candle in progress is not stored yet,
+// `live` rolls into it and the row is added at the top. Returns false (rows untouched) when the stored
+// candles end before the previous period, so there is no window to extend.
+bool overlay_live_row(LivePiCycle& live, double price, std::vector<PiCycleData>& rows) {
+    const long long step_ms = interval_ms(g_interval);
+    if (step_ms <= 0 || rows.empty() || rows[0].open_time != live.open_time()) return false;
+    const long long open_time = current_open_time(step_ms);
+    if (open_time == live.open_time() + step_ms) {
+        live.roll(open_time);
+        rows.insert(rows.begin(), PiCycleData());
+        rows.pop_back();
+    } else if (open_time != live.open_time()) {
+        return false;
+    }
+    live.set_price(price);
+    rows[0] = live.row();
+    return true;
+}
@@ -0,0 +1,30 @@
+#include "binance_klines/output.hpp"
+
+#include <cerrno>
+
+// For write() (POSIX)
+#include <unistd.h>
+
+// --- Output Sink ---
+/*----------------------------------------------------------------------------------------------------*/
+bool write_all(int fd, const void* buffer, size_t length) {
+    const char* p = static_cast<const char*>(buffer);
+    while (length > 0) {
+        ssize_t written = ::write(fd, p, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+OutputSink* g_stdout_sink = nullptr; // Installed by OutputSinkScope for the lifetime of main()
+
+/*----------------------------------------------------------------------------------------------------*/
+// Explicit flush point for output that should be visible before a slow operation
+void flush_output() {
+    if (g_stdout_sink) g_stdout_sink->flush();
+}
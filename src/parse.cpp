@@ -0,0 +1,218 @@
+#include "binance_klines/parse.hpp"
+#include "binance_klines/common.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <climits>
+#include <cctype>
+
+// For JSON parsing (nlohmann/json)
+#include "json.hpp"
+using json = nlohmann::json;
+
+// --- Date Parsing ---
+/*----------------------------------------------------------------------------------------------------*/
+// Parses "YYYY-MM-DD", rejecting dates that do not exist (e.g. 2021-02-30)
+bool parse_ymd(const std::string& text, EpochDay& day) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) return false;
+    }
+    const int y = std::atoi(text.substr(0, 4).c_str());
+    const unsigned m = (unsigned)std::atoi(text.substr(5, 2).c_str());
+    const unsigned d = (unsigned)std::atoi(text.substr(8, 2).c_str());
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    day = days_from_civil(y, m, d);
+
+    int check_y;
+    unsigned check_m, check_d;
+    civil_from_days(day, check_y, check_m, check_d);
+    return check_y == y && check_m == m && check_d == d;
+}
+
+// --- Fixed-Point Prices ---
+/*----------------------------------------------------------------------------------------------------*/
+// Parses a plain decimal string ("67012.34000000") into ticks of 10^-decimals. Digits past the scale
+// must be zeros, so a price that is not a whole number of ticks is rejected instead of rounded.
+bool parse_price_ticks(const std::string& text, int decimals, PriceTicks& ticks) {
+    const char* p = text.c_str();
+    bool negative = (*p == '-');
+    if (negative) ++p;
+    if (!std::isdigit(static_cast<unsigned char>(*p))) return false;
+
+    PriceTicks value = 0;
+    for (; std::isdigit(static_cast<unsigned char>(*p)); ++p) {
+        if (value > (LLONG_MAX - 9) / 10) return false;
+        value = value * 10 + (*p - '0');
+    }
+    int fraction_digits = 0;
+    if (*p == '.') {
+        for (++p; std::isdigit(static_cast<unsigned char>(*p)); ++p) {
+            if (fraction_digits < decimals) {
+                if (value > (LLONG_MAX - 9) / 10) return false;
+                value = value * 10 + (*p - '0');
+                ++fraction_digits;
+            } else if (*p != '0') {
+                return false;
+            }
+        }
+    }
+    if (*p != '\0' || value > LLONG_MAX / PRICE_SCALES[decimals - fraction_digits]) return false;
+    value *= PRICE_SCALES[decimals - fraction_digits];
+    ticks = negative ? -value : value;
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Decimals of an exchange tickSize: "0.01000000" -> 2, "1.00000000" -> 0. Returns -1 if unusable.
+int tick_size_decimals(const std::string& tick_size) {
+    size_t dot = tick_size.find('.');
+    size_t last = tick_size.find_last_not_of('0');
+    if (tick_size.empty() || !std::isdigit(static_cast<unsigned char>(tick_size[0])) || last == std::string::npos) return -1;
+    int decimals = (dot == std::string::npos || last <= dot) ? 0 : (int)(last - dot);
+    return decimals <= PRICE_MAX_DECIMALS ? decimals : -1;
+}
+
+// --- Symbols and Intervals ---
+/*----------------------------------------------------------------------------------------------------*/
+// Exchange symbol: one or more of A-Z and 0-9 ("BTCUSDT")
+bool valid_symbol(const std::string& symbol) {
+    return !symbol.empty() && symbol.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789") == std::string::npos;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One of the exchange's kline intervals, 1s through 1M
+bool valid_interval(const std::string& interval) {
+    return interval_ms(interval) > 0 || interval == "1M";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Candle length of a Binance interval string in ms, or 0 for intervals of variable length (1M)
+long long interval_ms(const std::string& interval) {
+    static const std::map<std::string, long long> lengths = {
+        {"1s", 1000LL}, {"1m", 60000LL}, {"3m", 180000LL}, {"5m", 300000LL}, {"15m", 900000LL},
+        {"30m", 1800000LL}, {"1h", 3600000LL}, {"2h", 7200000LL}, {"4h", 14400000LL}, {"6h", 21600000LL},
+        {"8h", 28800000LL}, {"12h", 43200000LL}, {"1d", 86400000LL}, {"3d", 259200000LL}, {"1w", 604800000LL}
+    };
+    auto it = lengths.find(interval);
+    return it != lengths.end() ? it->second : 0;
+}
+
+// --- Exchange Payloads ---
+/*----------------------------------------------------------------------------------------------------*/
+// Price decimals of `symbol` from the PRICE_FILTER tickSize of an /api/v3/exchangeInfo reply, or -1
+int parse_exchange_info_decimals(const std::string& body, const std::string& symbol) {
+    int decimals = -1;
+    try {
+        json info = json::parse(body);
+        if (info.contains("symbols") && !info["symbols"].empty()) {
+            for (const auto& filter : info["symbols"][0]["filters"]) {
+                if (filter.value("filterType", "") == "PRICE_FILTER") {
+                    decimals = tick_size_decimals(filter.value("tickSize", ""));
+                }
+            }
+        }
+        if (decimals < 0) {
+            std::cerr << "Error: No usable PRICE_FILTER tickSize for " << symbol << "." << std::endl;
+        } else if (g_debug_enabled) {
+            std::cout << "Debug: " << symbol << " prices have " << decimals << " decimals." << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing exchangeInfo: " << e.what() << std::endl;
+    }
+    return decimals;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Candles of an /api/v3/klines reply with prices in ticks of 10^-price_decimals. Empty when the
+// reply is an error or malformed, or when any price is off that grid, which sets `*off_grid`.
+std::vector<Kline> parse_klines(const std::string& body, const std::string& symbol, int price_decimals,
+                                bool* off_grid) {
+    std::vector<Kline> klines_data;
+    if (off_grid) *off_grid = false;
+    try {
+        json klines_json = json::parse(body);
+        if (klines_json.is_array()) {
+            klines_data.reserve(klines_json.size());
+            for (const auto& kline_array : klines_json) {
+                // [open_time, open, high, low, close, volume, close_time, quote_volume,
+                //  num_trades, taker_buy_base_volume, taker_buy_quote_volume, ignore]
+                Kline kline;
+                kline.open_time = kline_array[0].get<long long>();
+
+                if (!parse_price_ticks(kline_array[1].get_ref<const std::string&>(), price_decimals, kline.open)
+                    || !parse_price_ticks(kline_array[2].get_ref<const std::string&>(), price_decimals, kline.high)
+                    || !parse_price_ticks(kline_array[3].get_ref<const std::string&>(), price_decimals, kline.low)
+                    || !parse_price_ticks(kline_array[4].get_ref<const std::string&>(), price_decimals, kline.close)) {
+                    std::cerr << "Error: " << symbol << " price off the " << price_decimals
+                              << "-decimal tick grid; the tick size may have changed." << std::endl;
+                    if (off_grid) *off_grid = true;
+                    klines_data.clear();
+                    break;
+                }
+                kline.volume = std::stod(kline_array[5].get_ref<const std::string&>());
+                kline.close_time = kline_array[6].get<long long>();
+                kline.quote_volume = std::stod(kline_array[7].get_ref<const std::string&>());
+                kline.num_trades = kline_array[8].get<int>();
+                kline.taker_buy_base_volume = std::stod(kline_array[9].get_ref<const std::string&>());
+                kline.taker_buy_quote_volume = std::stod(kline_array[10].get_ref<const std::string&>());
+
+                // Calculate price as (high + low) / 2, rounded half up to a whole tick
+                kline.price = (kline.high + kline.low + 1) / 2;
+
+                klines_data.push_back(kline);
+            }
+            if (g_debug_enabled) {
+                std::cout << "Debug: Fetched " << klines_data.size() << " klines from Binance." << std::endl;
+            }
+        } else if (klines_json.is_object() && klines_json.contains("msg")) {
+            std::cerr << "Binance API Error: " << klines_json["msg"].get<std::string>() << std::endl;
+        } else {
+            std::cerr << "Unexpected JSON response from Binance API." << std::endl;
+        }
+    } catch (const json::parse_error& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        std::cerr << "Received data: " << body.substr(0, std::min((int)body.length(), 500)) << "..." << std::endl; // Print first 500 chars
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing klines data: " << e.what() << std::endl;
+    }
+    return klines_data;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Bid, ask and last of a Gemini /v1/pubticker reply; fields that could not be read stay as they are
+bool parse_gemini_ticker(const std::string& body, Ticker& ticker) {
+    try {
+        json data = json::parse(body);
+        ticker.bid = std::stod(data["bid"].get<std::string>());
+        ticker.ask = std::stod(data["ask"].get<std::string>());
+        ticker.last = std::stod(data["last"].get<std::string>());
+        return true;
+    } catch (const json::parse_error& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        std::cerr << "Received data: " << body.substr(0, std::min((int)body.length(), 500)) << "..." << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing Gemini ticker data: " << e.what() << std::endl;
+    }
+    return false;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Bid, ask and last of a Binance /api/v3/ticker/24hr reply; all zero when it could not be read
+bool parse_binance_ticker(const std::string& body, Ticker& ticker) {
+    try {
+        json data = json::parse(body);
+        ticker.bid = std::stod(data["bidPrice"].get<std::string>());
+        ticker.ask = std::stod(data["askPrice"].get<std::string>());
+        ticker.last = std::stod(data["lastPrice"].get<std::string>());
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing Binance ticker data: " << e.what() << std::endl;
+        ticker = {0.0, 0.0, 0.0};
+    }
+    return false;
+}
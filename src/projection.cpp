@@ -0,0 +1,577 @@
+#include "binance_klines/projection.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/render.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cctype>
+#include <cstdint>
+
+// For stat() on partition files (POSIX)
+#include <sys/stat.h>
+
+// --- Projection Horizons ---
+
+/*----------------------------------------------------------------------------------------------------*/
+// The `ahead`-th quarter end (ahead >= 1) strictly after `day`
+EpochDay quarter_end_after(EpochDay day, int ahead) {
+    int year;
+    unsigned month, month_day;
+    civil_from_days(day, year, month, month_day);
+    int quarter = (int)(month - 1) / 3; // 0..3, the quarter containing `day`
+    EpochDay end = 0;
+    for (int found = 0; found < ahead; ++quarter) {
+        const int next_year = year + (quarter + 1) / 4;
+        const unsigned next_month = (unsigned)((quarter + 1) % 4) * 3 + 1;
+        end = days_from_civil(next_year, next_month, 1) - 1; // Last day of the quarter
+        if (end > day) ++found;
+    }
+    return end;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The `ahead`-th December 31 (ahead >= 1) strictly after `day`
+EpochDay year_end_after(EpochDay day, int ahead) {
+    int year;
+    unsigned month, month_day;
+    civil_from_days(day, year, month, month_day);
+    if (days_from_civil(year, 12, 31) == day) ++year;
+    return days_from_civil(year + ahead - 1, 12, 31);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Horizons from a comma-separated list of "+N"/"+Nd"/"Nd" days, "+Nw"/"Nw" weeks, YYYY-MM-DD dates and
+// "qe"/"ye" (optionally "qe2", "ye3", ...: the second, third... end from today). Returns false on a
+// malformed entry; horizons that are not after today are dropped.
+bool parse_horizons(const std::string& spec, EpochDay today, std::vector<ProjectionHorizon>& horizons) {
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) continue;
+        ProjectionHorizon horizon;
+        EpochDay target = 0;
+        char label[32];
+        if (item.compare(0, 2, "qe") == 0 || item.compare(0, 2, "ye") == 0) {
+            int ahead = 1;
+            if (item.size() > 2) {
+                char* end = nullptr;
+                ahead = (int)std::strtol(item.c_str() + 2, &end, 10);
+                if (*end != '\0' || ahead < 1 || ahead > 400) return false;
+            }
+            int year;
+            unsigned month, month_day;
+            if (item[0] == 'q') {
+                target = quarter_end_after(today, ahead);
+                civil_from_days(target, year, month, month_day);
+                std::snprintf(label, sizeof(label), "Q%u %d", (month + 2) / 3, year);
+            } else {
+                target = year_end_after(today, ahead);
+                civil_from_days(target, year, month, month_day);
+                std::snprintf(label, sizeof(label), "%d", year);
+            }
+            horizon.label = label;
+        } else if (std::isdigit(static_cast<unsigned char>(item[0])) && item.size() == 10 && item[4] == '-') {
+            if (!parse_ymd(item, target)) return false;
+            horizon.label = item;
+        } else {
+            const char* text = item.c_str() + (item[0] == '+' ? 1 : 0);
+            char* end = nullptr;
+            long count = std::strtol(text, &end, 10);
+            if (end == text || count <= 0 || count > 36500) return false;
+            char unit = 'd';
+            if (*end == 'w' || *end == 'd') unit = *end++;
+            if (*end != '\0') return false;
+            target = today + (EpochDay)(unit == 'w' ? count * 7 : count);
+            std::snprintf(label, sizeof(label), "+%ld%c", count, unit);
+            horizon.label = label;
+        }
+        horizon.days = (int)(target - today);
+        if (horizon.days > 0) horizons.push_back(horizon);
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Mean step of the newest PROJECTION_STEP_ROWS display rows (newest first)
+double average_recent_step(const std::vector<PiCycleData>& pi_data_reversed) {
+    const size_t count = std::min(pi_data_reversed.size(), (size_t)PROJECTION_STEP_ROWS);
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) sum += pi_data_reversed[i].step;
+    return count > 0 ? sum / count : 0.0;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void project_horizons(const ProjectionInputs& inputs, const std::vector<ProjectionHorizon>& horizons, ProjectionGrid& grid) {
+    const size_t symbols = inputs.baseline.size();
+    grid.step.resize(horizons.size() * symbols);
+    grid.trend.resize(horizons.size() * symbols);
+    const double* baseline = inputs.baseline.data();
+    const double* step = inputs.average_step.data();
+    const double* increase = inputs.daily_increase.data();
+    for (size_t h = 0; h < horizons.size(); ++h) {
+        const double days = horizons[h].days;
+        double* __restrict step_out = &grid.step[h * symbols];
+        double* __restrict trend_out = &grid.trend[h * symbols];
+        for (size_t s = 0; s < symbols; ++s) {
+            step_out[s] = baseline[s] + step[s] * days;
+            trend_out[s] = baseline[s] + increase[s] * days;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// "label" centered in `width` columns
+std::string centered(const std::string& label, size_t width) {
+    if (label.size() >= width) return label;
+    const size_t left = (width - label.size()) / 2;
+    return std::string(left, ' ') + label + std::string(width - label.size() - left, ' ');
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void prediction_target_step(const std::vector<PiCycleData>& pi_data_reversed, double avg_daily_increase,
+                            const std::vector<ProjectionHorizon>& horizons) {
+    const double average_top_steps = average_recent_step(pi_data_reversed);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "| " << PROJECTION_STEP_ROWS << "-day Avg Step: " << average_top_steps << " (Dynamic 364-day Price-based)" << std::endl;
+    std::cout << "| 4-year Avg Daily Increase: " << avg_daily_increase << " (Long-run trend)" << std::endl;
+
+    // Predictions: step-based (recent 364-day dynamic step) and trend-based (long-run average daily increase)
+    ProjectionInputs inputs;
+    inputs.symbols.push_back(g_symbol);
+    inputs.baseline.push_back(pi_data_reversed.empty() ? 0.0 : pi_data_reversed[0].median);
+    inputs.average_step.push_back(average_top_steps);
+    inputs.daily_increase.push_back(avg_daily_increase);
+    ProjectionGrid grid;
+    project_horizons(inputs, horizons, grid);
+
+    const EpochDay today = current_epoch_day();
+    std::cout << "+------------+------------+------------+-------------------------------+" << std::endl;
+    std::cout << "|   Target   |    Step    |   Trend    | Date" << std::endl;
+    std::cout << "+------------+------------+------------+-------------------------------+" << std::endl;
+    for (size_t h = 0; h < horizons.size(); ++h) {
+        char date[20];
+        format_long_date(today + horizons[h].days, date);
+        std::cout << "| " << centered(horizons[h].label, 10)
+                  << " | " << std::setw(10) << std::right << ("$" + format_numeric(grid.step[h]))
+                  << " | " << std::setw(10) << std::right << ("$" + format_numeric(grid.trend[h])) << " | "
+                  << date << std::endl;
+    }
+    std::cout << "+------------+------------+------------+-------------------------------+" << std::endl;
+}
+/*----------------------------------------------------------------------------------------------------*/
+// Baseline, average step and long-run daily increase of the partition at `db_path`, from its newest
+// rows only. Returns false when the partition can't be opened or has no rows.
+bool load_projection_inputs(const std::string& db_path, double& baseline, double& average_step, double& daily_increase) {
+    KlineStore store;
+    if (!store.open(db_path)) return false;
+    KlineColumns tail = load_price_tail(store.db(), PROJECTION_STEP_ROWS + PI_CYCLE_LOOKBACK_ROWS);
+    std::vector<PiCycleData> rows = compute_display_rows(price_series_view(tail), PROJECTION_STEP_ROWS);
+    if (rows.empty()) return false;
+    baseline = rows[0].median;
+    average_step = average_recent_step(rows);
+    KlineColumns trend_window = load_price_window(store.db(), trailing_days_cutoff_ms(PROJECTION_TREND_DAYS), 0);
+    daily_increase = DailyChangeAggregates(price_series_view(trend_window)).average_change_days(PROJECTION_TREND_DAYS);
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Projects every `interval` partition in the catalog at every horizon: the inputs are loaded on up to
+// `threads` workers, then one project_horizons() call computes the whole grid
+void run_projection_grid(KlineCatalog& catalog, const std::string& interval, const std::vector<ProjectionHorizon>& horizons, int threads) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<PartitionInfo> partitions;
+    for (const auto& partition : catalog.partitions()) {
+        struct stat st;
+        if (partition.interval == interval && stat(partition.path.c_str(), &st) == 0) partitions.push_back(partition);
+    }
+    std::vector<double> baseline(partitions.size()), step(partitions.size()), increase(partitions.size());
+    std::vector<char> loaded(partitions.size(), 0);
+    run_parallel(partitions.size(), threads, [&](size_t i) {
+        loaded[i] = load_projection_inputs(partitions[i].path, baseline[i], step[i], increase[i]);
+    });
+
+    ProjectionInputs inputs;
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        if (!loaded[i]) continue;
+        inputs.symbols.push_back(partitions[i].symbol);
+        inputs.baseline.push_back(baseline[i]);
+        inputs.average_step.push_back(step[i]);
+        inputs.daily_increase.push_back(increase[i]);
+    }
+    const auto project_start = std::chrono::steady_clock::now();
+    ProjectionGrid grid;
+    project_horizons(inputs, horizons, grid);
+    const auto end = std::chrono::steady_clock::now();
+
+    const EpochDay today = current_epoch_day();
+    const size_t symbols = inputs.symbols.size();
+    std::cout << "+------------+------------+--------------+--------------+--------------------+" << std::endl;
+    std::cout << "| Symbol     |   Target   |     Step     |    Trend     | Date" << std::endl;
+    std::cout << "+------------+------------+--------------+--------------+--------------------+" << std::endl;
+    for (size_t s = 0; s < symbols; ++s) {
+        for (size_t h = 0; h < horizons.size(); ++h) {
+            char date[20];
+            format_long_date(today + horizons[h].days, date);
+            std::cout << "| " << std::setw(10) << std::left << (h == 0 ? inputs.symbols[s] : "") << std::right
+                      << " | " << centered(horizons[h].label, 10)
+                      << " | " << std::setw(12) << ("$" + format_numeric(grid.step[h * symbols + s]))
+                      << " | " << std::setw(12) << ("$" + format_numeric(grid.trend[h * symbols + s])) << " | "
+                      << date << std::endl;
+        }
+        std::cout << "+------------+------------+--------------+--------------+--------------------+" << std::endl;
+    }
+    std::cout << "Projected " << symbols << " " << interval << " partitions x " << horizons.size() << " horizons: "
+              << std::fixed << std::setprecision(1)
+              << std::chrono::duration<double, std::milli>(project_start - start).count() << " ms loading, "
+              << std::setprecision(3) << std::chrono::duration<double, std::milli>(end - project_start).count()
+              << " ms projecting" << std::endl;
+}
+
+// --- Monte Carlo Projection ---
+const size_t MC_BLOCK_PATHS   = 2048;
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define MC_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define MC_SIMD_CLONES
+#endif
+
+struct CounterKey {
+    uint32_t k0;
+    uint32_t k1;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// lowbias32 (Chris Wellons): a 32-bit bijective integer hash with good avalanche
+inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Key of one random stream (a bootstrap step or a GBM variate) under `seed`
+inline CounterKey counter_key(uint64_t seed, uint64_t stream) {
+    const uint64_t h = splitmix64(seed ^ splitmix64(stream));
+    CounterKey key = {(uint32_t)h, (uint32_t)(h >> 32)};
+    return key;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Random 32 bits for `counter` (the path) in the stream of `key`: two keyed rounds of mix32
+inline uint32_t counter_random(uint32_t counter, CounterKey key) {
+    return mix32(mix32(counter + key.k0) ^ key.k1);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One bootstrap step for paths [first_path, first_path + lanes): add a uniformly drawn entry of
+// `returns` to each log price. The index is the high half of random * count.
+MC_SIMD_CLONES
+void bootstrap_step(double* __restrict log_price, uint32_t first_path, size_t lanes,
+                    const double* __restrict returns, uint32_t count, CounterKey key) {
+    for (size_t j = 0; j < lanes; ++j) {
+        const uint32_t r = counter_random(first_path + (uint32_t)j, key);
+        log_price[j] += returns[(uint32_t)(((uint64_t)r * count) >> 32)];
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One exact GBM increment of `drift` + `sigma` * N(0,1) per path, the normal variate by Box-Muller.
+// Runs once per target date, so libm's scalar log/cos are not worth a vector clone.
+void gbm_step(double* __restrict log_price, uint32_t first_path, size_t lanes,
+              double drift, double sigma, CounterKey key_radius, CounterKey key_angle) {
+    const double TWO_POW_MINUS_32 = 1.0 / 4294967296.0;
+    const double TWO_PI = 6.283185307179586;
+    for (size_t j = 0; j < lanes; ++j) {
+        const double u = (counter_random(first_path + (uint32_t)j, key_radius) + 0.5) * TWO_POW_MINUS_32; // (0, 1)
+        const double v = counter_random(first_path + (uint32_t)j, key_angle) * TWO_POW_MINUS_32;
+        log_price[j] += drift + sigma * std::sqrt(-2.0 * std::log(u)) * std::cos(TWO_PI * v);
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Log returns between consecutive rows, for rows opened at or after from_ms
+std::vector<double> log_returns_since(PriceSeriesView series, long long from_ms) {
+    std::vector<double> returns;
+    size_t first = (size_t)(std::lower_bound(series.open_time, series.open_time + series.size, from_ms) - series.open_time);
+    for (size_t i = std::max(first, (size_t)1); i < series.size; ++i) {
+        if (series.price[i - 1] > 0 && series.price[i] > 0) {
+            returns.push_back(std::log(series.price[i] / series.price[i - 1]));
+        }
+    }
+    return returns;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Percentile bands of `paths` simulated prices, starting at start_price, after each of
+// `horizon_steps` (ascending, > 0) candles. Empty when there are no returns to draw from.
+std::vector<MonteCarloBand> simulate_price_bands(const std::vector<double>& log_returns, MonteCarloModel model,
+                                                 double start_price, const std::vector<int>& horizon_steps,
+                                                 size_t paths, int threads, uint64_t seed) {
+    std::vector<MonteCarloBand> bands;
+    if (log_returns.empty() || horizon_steps.empty() || paths == 0) return bands;
+    paths = std::min(paths, (size_t)UINT32_MAX); // Path numbers are 32-bit counters
+
+    double mean = 0.0, variance = 0.0;
+    for (double r : log_returns) mean += r;
+    mean /= (double)log_returns.size();
+    for (double r : log_returns) variance += (r - mean) * (r - mean);
+    const double std_dev = log_returns.size() > 1 ? std::sqrt(variance / (double)(log_returns.size() - 1)) : 0.0;
+
+    // Log price of every path on every target, one column per target
+    const auto start = std::chrono::steady_clock::now();
+    const size_t horizons = horizon_steps.size();
+    std::vector<float> ends(horizons * paths);
+    const size_t blocks = (paths + MC_BLOCK_PATHS - 1) / MC_BLOCK_PATHS;
+    run_parallel(blocks, threads, [&](size_t b) {
+        double log_price[MC_BLOCK_PATHS];
+        const uint32_t first = (uint32_t)(b * MC_BLOCK_PATHS);
+        const size_t lanes = std::min(MC_BLOCK_PATHS, paths - first);
+        std::fill(log_price, log_price + lanes, 0.0);
+        int step = 0;
+        for (size_t h = 0; h < horizons; ++h) {
+            if (model == MC_GBM) {
+                const int span = horizon_steps[h] - step;
+                gbm_step(log_price, first, lanes, mean * span, std_dev * std::sqrt((double)span),
+                         counter_key(seed, ~(2 * (uint64_t)h)), counter_key(seed, ~(2 * (uint64_t)h + 1)));
+                step = horizon_steps[h];
+            }
+            for (; step < horizon_steps[h]; ++step) {
+                bootstrap_step(log_price, first, lanes, log_returns.data(), (uint32_t)log_returns.size(),
+                               counter_key(seed, (uint64_t)step));
+            }
+            float* column = &ends[h * paths + first];
+            for (size_t j = 0; j < lanes; ++j) column[j] = (float)log_price[j];
+        }
+    });
+
+    if (g_debug_enabled) {
+        std::cout << "Debug: Simulated " << paths << " paths to step " << horizon_steps.back() << " in "
+                  << elapsed_ms(start) << " ms." << std::endl;
+    }
+
+    bands.resize(horizons);
+    run_parallel(horizons, threads, [&](size_t h) {
+        MonteCarloBand& band = bands[h];
+        float* column = &ends[h * paths];
+        double sum = 0.0;
+        for (size_t i = 0; i < paths; ++i) sum += std::exp((double)column[i]);
+        band.steps = horizon_steps[h];
+        band.mean = start_price * sum / (double)paths;
+        size_t done = 0; // Each selection only searches above the previous one
+        for (size_t q = 0; q < MC_PERCENTILE_COUNT; ++q) {
+            const size_t k = (size_t)std::llround(MC_PERCENTILES[q] / 100.0 * (double)(paths - 1));
+            std::nth_element(column + done, column + k, column + paths);
+            band.price[q] = start_price * std::exp((double)column[k]);
+            done = k;
+        }
+    });
+    return bands;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Band table in place of the step projection
+void print_monte_carlo(const std::vector<MonteCarloBand>& bands, const std::vector<ProjectionHorizon>& targets,
+                       MonteCarloModel model, size_t paths, size_t returns, double ms, int threads) {
+    const EpochDay today = current_epoch_day();
+    std::cout << "| Monte Carlo (" << (model == MC_GBM ? "GBM" : "bootstrap") << "): " << format_numeric((double)paths)
+              << " paths from " << format_numeric((double)returns) << " historical returns, "
+              << std::fixed << std::setprecision(0) << ms << " ms on " << threads << (threads == 1 ? " thread" : " threads")
+              << std::endl;
+    std::cout << "+------------+------------+------------+------------+------------+------------+------------+--------------------+" << std::endl;
+    std::cout << "|   Target   |     P5     |    P25     |   Median   |    P75     |    P95     |    Mean    | Date" << std::endl;
+    std::cout << "+------------+------------+------------+------------+------------+------------+------------+--------------------+" << std::endl;
+    for (size_t h = 0; h < bands.size(); ++h) {
+        char date[32];
+        format_long_date(today + targets[h].days, date);
+        std::cout << "| " << centered(targets[h].label, 10);
+        for (size_t q = 0; q < MC_PERCENTILE_COUNT; ++q) {
+            std::cout << " | " << std::setw(10) << ("$" + format_numeric(bands[h].price[q]));
+        }
+        std::cout << " | " << std::setw(10) << ("$" + format_numeric(bands[h].mean)) << " | " << date << std::endl;
+    }
+    std::cout << "+------------+------------+------------+------------+------------+------------+------------+--------------------+" << std::endl;
+}
+
+// --- Walk-Forward Evaluation ---
+
+enum WalkForwardModel { WF_STEP, WF_TREND, WF_NAIVE, WF_MODEL_COUNT };
+enum WalkForwardHorizon { WF_DAYS, WF_YEAR_END, WF_HORIZON_COUNT };
+
+const char* const WF_MODEL_NAMES[WF_MODEL_COUNT] = {"Step", "Trend", "Naive"};
+
+// Percentage errors of one model at one horizon: (predicted - realized) / realized
+struct ForecastErrors {
+    long long count          = 0;
+    long long directions     = 0; // Predictions with a direction (predicted != current)
+    long long direction_hits = 0;
+    double    sum            = 0.0;
+    double    sum_abs        = 0.0;
+    double    sum_sq         = 0.0;
+
+    void add(double predicted, double realized, double current) {
+        if (!(realized > 0)) return;
+        const double error = (predicted - realized) / realized * 100.0;
+        ++count;
+        sum += error;
+        sum_abs += std::fabs(error);
+        sum_sq += error * error;
+        if (predicted != current) {
+            ++directions;
+            if ((predicted > current) == (realized > current)) ++direction_hits;
+        }
+    }
+
+    void merge(const ForecastErrors& other) {
+        count += other.count;
+        directions += other.directions;
+        direction_hits += other.direction_hits;
+        sum += other.sum;
+        sum_abs += other.sum_abs;
+        sum_sq += other.sum_sq;
+    }
+};
+
+struct WalkForwardResult {
+    PartitionInfo  partition;
+    size_t         rows = 0;
+    ForecastErrors errors[WF_HORIZON_COUNT][WF_MODEL_COUNT];
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// Scores the step, trend and naive projections of every row of `series` whose full step window is
+// stored, against the price horizon_days later and on December 31 of the row's year
+void evaluate_walk_forward(PriceSeriesView series, int horizon_days, WalkForwardResult& result) {
+    result.rows = series.size;
+    const size_t first_row = (size_t)PI_CYCLE_LOOKBACK_ROWS + PROJECTION_STEP_ROWS - 1;
+    if (series.size <= first_row) return;
+
+    PiCycleIndex index;
+    index.build(series);
+    const double* price = series.price;
+    auto step_of = [price](size_t i) { return (price[i] - price[i - PI_CYCLE_LOOKBACK_ROWS]) / PI_CYCLE_LOOKBACK_ROWS; };
+
+    double step_sum = 0.0; // Steps of rows (i - PROJECTION_STEP_ROWS, i]
+    for (size_t i = first_row + 1 - PROJECTION_STEP_ROWS; i < first_row; ++i) step_sum += step_of(i);
+    size_t trend_first = 0;
+    for (size_t i = first_row; i < series.size; ++i) {
+        step_sum += step_of(i);
+        if (i > first_row) step_sum -= step_of(i - PROJECTION_STEP_ROWS);
+
+        const EpochDay day = epoch_day(series.open_time[i]);
+        const long long trend_cutoff = epoch_day_to_ms(day - PROJECTION_TREND_DAYS);
+        while (series.open_time[trend_first] < trend_cutoff) ++trend_first;
+        const double trend = i > trend_first ? (price[i] - price[trend_first]) / (double)(i - trend_first) : 0.0;
+        const double average_step = step_sum / PROJECTION_STEP_ROWS;
+        const double baseline = index.row(i).median;
+
+        int year;
+        unsigned month, month_day;
+        civil_from_days(day, year, month, month_day);
+        const int spans[WF_HORIZON_COUNT] = {horizon_days, (int)(days_from_civil(year, 12, 31) - day)};
+        for (int h = 0; h < WF_HORIZON_COUNT; ++h) {
+            if (spans[h] <= 0) continue;
+            size_t begin, end;
+            index.rows_for_days(day + spans[h], day + spans[h], begin, end);
+            if (begin == end) continue; // Past the end of the series, or a gap
+            const double realized = price[begin];
+            result.errors[h][WF_STEP].add(baseline + average_step * spans[h], realized, price[i]);
+            result.errors[h][WF_TREND].add(baseline + trend * spans[h], realized, price[i]);
+            result.errors[h][WF_NAIVE].add(price[i], realized, price[i]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Evaluates every `interval` partition in the catalog on up to `threads` workers and prints one block
+// of rows per partition plus the pooled totals
+void run_walk_forward(KlineCatalog& catalog, const std::string& interval, int horizon_days, int threads) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<WalkForwardResult> results;
+    for (const auto& partition : catalog.partitions()) {
+        struct stat st;
+        if (partition.interval != interval || stat(partition.path.c_str(), &st) != 0) continue;
+        WalkForwardResult result;
+        result.partition = partition;
+        results.push_back(result);
+    }
+
+    run_parallel(results.size(), threads, [&](size_t i) {
+        KlineStore store;
+        if (!store.open(results[i].partition.path)) return;
+        KlineColumns klines = load_kline_columns(store.db(), KLINE_OPEN_TIME | KLINE_PRICE);
+        evaluate_walk_forward(price_series_view(klines), horizon_days, results[i]);
+    });
+    const double ms = elapsed_ms(start);
+
+    WalkForwardResult pooled;
+    pooled.partition.symbol = "All";
+    for (const auto& result : results) {
+        pooled.rows += result.rows;
+        for (int h = 0; h < WF_HORIZON_COUNT; ++h) {
+            for (int m = 0; m < WF_MODEL_COUNT; ++m) pooled.errors[h][m].merge(result.errors[h][m]);
+        }
+    }
+    const size_t partitions = results.size();
+    long long projections = 0;
+    for (int h = 0; h < WF_HORIZON_COUNT; ++h) projections += pooled.errors[h][WF_STEP].count;
+    if (partitions > 1) results.push_back(pooled);
+
+    char horizon_label[16];
+    std::snprintf(horizon_label, sizeof(horizon_label), "+%dd", horizon_days);
+    const char* horizon_labels[WF_HORIZON_COUNT] = {horizon_label, "Year end"};
+
+    std::cout << "Walk-forward evaluation of the " << interval << " projections (errors in % of the realized price)" << std::endl;
+    std::cout << "+------------+----------+-------+----------+----------+----------+----------+-----------+" << std::endl;
+    std::cout << "| Symbol     | Horizon  | Model |   Days   |  Bias %  |  MAE %   |  RMSE %  | Direction |" << std::endl;
+    std::cout << "+------------+----------+-------+----------+----------+----------+----------+-----------+" << std::endl;
+    for (const auto& result : results) {
+        for (int h = 0; h < WF_HORIZON_COUNT; ++h) {
+            for (int m = 0; m < WF_MODEL_COUNT; ++m) {
+                const ForecastErrors& e = result.errors[h][m];
+                char bias[32] = "-", mae[32] = "-", rmse[32] = "-", direction[32] = "-";
+                if (e.count > 0) {
+                    std::snprintf(bias, sizeof(bias), "%+.2f", e.sum / e.count);
+                    std::snprintf(mae, sizeof(mae), "%.2f", e.sum_abs / e.count);
+                    std::snprintf(rmse, sizeof(rmse), "%.2f", std::sqrt(e.sum_sq / e.count));
+                }
+                if (e.directions > 0) {
+                    std::snprintf(direction, sizeof(direction), "%.1f%%", 100.0 * e.direction_hits / e.directions);
+                }
+                std::cout << "| " << std::setw(10) << std::left << (h == 0 && m == 0 ? result.partition.symbol : "")
+                          << " | " << std::setw(8) << (m == 0 ? horizon_labels[h] : "")
+                          << " | " << std::setw(5) << WF_MODEL_NAMES[m] << std::right
+                          << " | " << std::setw(8) << e.count
+                          << " | " << std::setw(8) << bias
+                          << " | " << std::setw(8) << mae
+                          << " | " << std::setw(8) << rmse
+                          << " | " << std::setw(9) << direction << " |" << std::endl;
+            }
+        }
+        std::cout << "+------------+----------+-------+----------+----------+----------+----------+-----------+" << std::endl;
+    }
+    std::cout << "Partitions: " << partitions << ", rows: " << pooled.rows
+              << ", projections scored: " << projections << ", " << std::fixed << std::setprecision(1) << ms << " ms" << std::endl;
+}
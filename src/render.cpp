@@ -0,0 +1,421 @@
+#include "binance_klines/render.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/fetch.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/formats.hpp"
+#include "binance_klines/indicators.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+// For STDOUT_FILENO (POSIX)
+#include <unistd.h>
+
+// For shortest round-trip number formatting (Grisu2, header-only)
+#include "grisu2.hpp"
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Table Renderer ---
+
+/*----------------------------------------------------------------------------------------------------*/
+// round(value * 10^decimals) to an integer exactly as printf("%.Nf") rounds: on the exact binary
+// value, ties to even. The fma residual recovers what the multiplication rounded away, which decides
+// the cases where the product lands on a half. Only for value * 10^decimals below 2^53.
+inline unsigned long long round_scaled(double magnitude, int decimals) {
+    const double scale = DECIMAL_SCALES[decimals];
+    const double product = magnitude * scale;
+    const double residual = std::fma(magnitude, scale, -product);
+    double rounded = std::nearbyint(product);
+    const double fraction = product - rounded;
+    if (fraction == 0.5 && residual > 0) rounded += 1;
+    else if (fraction == -0.5 && residual < 0) rounded -= 1;
+    return (unsigned long long)rounded;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Writes `value` with `decimals` fraction digits (std::fixed), optionally grouping the integer part
+// with commas, into `out` (at least 400 bytes). Returns the length. NaN and infinities are written
+// as "nan"/"inf".
+size_t format_fixed(double value, int decimals, bool group_thousands, char* out) {
+    char* p = out;
+    if (std::signbit(value)) *p++ = '-';
+    if (std::isnan(value) || std::isinf(value)) {
+        std::memcpy(p, std::isnan(value) ? "nan" : "inf", 3);
+        return (size_t)(p - out) + 3;
+    }
+    const double magnitude = std::fabs(value);
+
+    // Digits of the magnitude without a point, written backwards from the end of `digits`
+    char digits[400];
+    char* end = digits + sizeof(digits);
+    char* first = end;
+    if (magnitude * DECIMAL_SCALES[decimals] < 9007199254740992.0) {
+        unsigned long long scaled = round_scaled(magnitude, decimals);
+        while (scaled >= 100) {
+            first -= 2;
+            write_two_digits(first, (unsigned)(scaled % 100));
+            scaled /= 100;
+        }
+        if (scaled >= 10) {
+            first -= 2;
+            write_two_digits(first, (unsigned)scaled);
+        } else {
+            *--first = (char)('0' + scaled);
+        }
+        while (end - first <= decimals) *--first = '0'; // At least one integer digit
+    } else {
+        int length = std::snprintf(digits, sizeof(digits), "%.*f", decimals, magnitude); // Beyond 2^53: no fraction
+        if (decimals > 0) {
+            std::memmove(digits + length - decimals - 1, digits + length - decimals, decimals);
+            --length;
+        }
+        first = end - length;
+        std::memmove(first, digits, length);
+    }
+
+    const size_t integer_digits = (size_t)(end - first) - decimals;
+    for (size_t i = 0; i < integer_digits; ++i) {
+        if (group_thousands && i > 0 && (integer_digits - i) % 3 == 0) *p++ = ',';
+        *p++ = first[i];
+    }
+    if (decimals > 0) {
+        *p++ = '.';
+        std::memcpy(p, first + integer_digits, decimals);
+        p += decimals;
+    }
+    return (size_t)(p - out);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Whole-number string with thousands separators; empty for NaN
+std::string format_numeric(double value) {
+    if (std::isnan(value)) return "";
+    char buffer[512];
+    return std::string(buffer, format_fixed(value, 0, true, buffer));
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+inline double pi_table_value(const PiCycleData& row, PiTableValue value) {
+    switch (value) {
+        case PI_TABLE_PRICE:    return row.price;
+        case PI_TABLE_MOVE:     return row.move;
+        case PI_TABLE_OFFSET:   return row.offset;
+        case PI_TABLE_CEILING:  return row.ceiling;
+        case PI_TABLE_MEDIAN:   return row.median;
+        case PI_TABLE_FLOOR:    return row.floor;
+        case PI_TABLE_STEP:     return row.step;
+        case PI_TABLE_CHANGE:   return row.change;
+        case PI_TABLE_WEEKS_52: return row.weeks_52;
+        default:                return 0.0;
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Row color from where the price sits between floor, median and ceiling
+const char* pi_row_color(const PiCycleData& row) {
+    const double median_threshold = row.median * 0.02;
+    if (std::abs(row.price - row.median) <= median_threshold) {
+        if (row.price > row.median) return "\033[38;5;142m";  // Yellow-green
+        if (row.price < row.median) return "\033[38;5;208m";  // Yellow-red
+        return "\033[93m";                                     // Yellow
+    }
+    if (row.price >= row.median) {
+        double range_above = row.ceiling - row.median;
+        double percentage_above = (range_above > 0) ? (row.price - row.median) / range_above : 0.0;
+        if (percentage_above >= 0.575) return "\033[92m";     // Bright green
+        if (percentage_above >= 0.29) return "\033[32m";      // Green
+        return "\033[38;5;22m";                                // Dark green
+    }
+    double range_below = row.median - row.floor;
+    double percentage_below = (range_below > 0) ? (row.median - row.price) / range_below : 0.0;
+    if (percentage_below >= 0.575) return "\033[38;5;196m";   // Bright red
+    if (percentage_below >= 0.29) return "\033[91m";          // Red
+    return "\033[38;5;52m";                                    // Dark red
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One padded cell of `row` without its " |" separator; `out` needs PI_TABLE_CELL_MAX_BYTES.
+// Returns the new end.
+char* render_pi_cell(char* out, const PiCycleData& row, const PiTableColumn& column) {
+    char cell[PI_TABLE_CELL_MAX_BYTES];
+    size_t length = 0;
+    if (column.space) cell[length++] = ' ';
+    if (column.value == PI_TABLE_DATE) {
+        format_ymd(epoch_day(row.open_time), cell + length);
+        length += DATE_BUFFER_SIZE - 1;
+    } else {
+        double value = pi_table_value(row, column.value);
+        if (column.percent) {
+            length += format_fixed(value, column.decimals, false, cell + length);
+            cell[length++] = '%';
+        } else if (!std::isnan(value)) {
+            length += format_fixed(value, column.decimals, true, cell + length);
+        }
+    }
+    size_t padding = length < (size_t)column.width ? (size_t)column.width - length : 0;
+    if (!column.left) {
+        std::memset(out, ' ', padding);
+        out += padding;
+    }
+    out = append_text(out, cell, length);
+    if (column.left) {
+        std::memset(out, ' ', padding);
+        out += padding;
+    }
+    return out;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One colored table row, newline included; `out` needs PI_TABLE_ROW_MAX_BYTES. Returns the new end.
+char* render_pi_row(char* out, const PiCycleData& row) {
+    const char* color = pi_row_color(row);
+    out = append_text(out, color, std::strlen(color));
+    *out++ = '|';
+    for (const PiTableColumn& column : PI_TABLE_COLUMNS) {
+        out = render_pi_cell(out, row, column);
+        out = append_text(out, " |", 2);
+    }
+    out = append_text(out, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+    *out++ = '\n';
+    return out;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void display_public(const std::vector<PiCycleData>& pi_data_reversed) {
+    // Extract first row values for global variables
+    if (!pi_data_reversed.empty()) {
+        const auto& first_row  = pi_data_reversed[0];
+        first_row_yearly_value = first_row.weeks_52;
+        first_row_step         = first_row.step;
+        first_row_avg_price    = first_row.price;
+    }
+
+    std::vector<char> buffer(3 * sizeof(PI_TABLE_RULE) + pi_data_reversed.size() * PI_TABLE_ROW_BYTES + PI_TABLE_ROW_MAX_BYTES);
+    char* out = buffer.data();
+    out = append_text(out, PI_TABLE_RULE, sizeof(PI_TABLE_RULE) - 1);
+    out = append_text(out, PI_TABLE_HEADER, sizeof(PI_TABLE_HEADER) - 1);
+    out = append_text(out, PI_TABLE_RULE, sizeof(PI_TABLE_RULE) - 1);
+    for (const auto& row : pi_data_reversed) {
+        size_t used = (size_t)(out - buffer.data());
+        if (buffer.size() - used < PI_TABLE_ROW_MAX_BYTES + sizeof(PI_TABLE_RULE)) { // Only for absurdly wide values
+            buffer.resize(buffer.size() * 2);
+            out = buffer.data() + used;
+        }
+        out = render_pi_row(out, row);
+    }
+    out = append_text(out, PI_TABLE_RULE, sizeof(PI_TABLE_RULE) - 1);
+
+    if (g_stdout_sink) {
+        g_stdout_sink->write_block(buffer.data(), (size_t)(out - buffer.data()));
+    } else {
+        std::cout.flush(); // Keep ordering with anything already written through std::cout
+        write_all(STDOUT_FILENO, buffer.data(), (size_t)(out - buffer.data()));
+    }
+}
+
+// --- Date Queries ---
+/*----------------------------------------------------------------------------------------------------*/
+// Prints the rows of the days from..to. Returns false if the series has none there.
+bool run_date_query(PriceSeriesView series, EpochDay from, EpochDay to) {
+    auto start = std::chrono::steady_clock::now();
+    PiCycleIndex index;
+    index.build(series);
+    double build_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<PiCycleData> rows = index.query(from, to);
+    double query_us = elapsed_ms(start) * 1000.0;
+
+    if (g_debug_enabled) {
+        std::cout << "Debug: Indexed " << index.size() << " rows in " << std::fixed << std::setprecision(2) << build_ms
+                  << " ms; query answered " << rows.size() << " rows in " << query_us << " us." << std::endl;
+    }
+    if (rows.empty()) {
+        char from_text[DATE_BUFFER_SIZE], to_text[DATE_BUFFER_SIZE];
+        std::cerr << "No " << g_symbol << " " << g_interval << " klines";
+        if (index.size() > 0) {
+            // Open-ended sides are shown as the ends of the series
+            std::cerr << " between " << format_ymd(from == INT32_MIN ? index.first_day() : from, from_text)
+                      << " and " << format_ymd(to == INT32_MAX ? index.last_day() : to, to_text);
+        }
+        std::cerr << "." << std::endl;
+        return false;
+    }
+    display_public(rows);
+    return true;
+}
+
+// --- Series Export ---
+/*----------------------------------------------------------------------------------------------------*/
+bool parse_series_format(const std::string& name, SeriesFormat& format) {
+    if (name == "csv") format = SERIES_CSV;
+    else if (name == "json") format = SERIES_JSON;
+    else if (name == "ndjson") format = SERIES_NDJSON;
+    else return false;
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void SeriesWriter::begin() {
+    if (format_ == SERIES_CSV) {
+        std::string header = "date,open_time";
+        for (const SeriesField& field : SERIES_FIELDS) header += std::string(",") + field.name;
+        header += '\n';
+        emit(header.data(), header.size());
+    } else if (format_ == SERIES_JSON) {
+        emit("[", 1);
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void SeriesWriter::row(const PiCycleData& data) {
+    char line[1024]; // 13 fields of at most 32 characters plus names
+    char* out = line;
+    const bool csv = format_ == SERIES_CSV;
+    if (format_ == SERIES_JSON) {
+        out = append_text(out, rows_ ? ",\n" : "\n", rows_ ? 2 : 1);
+    }
+    if (!csv) out = append_text(out, "{\"date\":\"", 9);
+    format_ymd(epoch_day(data.open_time), out);
+    out += DATE_BUFFER_SIZE - 1;
+    out = csv ? append_text(out, ",", 1) : append_text(out, "\",\"open_time\":", 14);
+    out += std::snprintf(out, 24, "%lld", data.open_time);
+    for (const SeriesField& field : SERIES_FIELDS) {
+        if (csv) {
+            *out++ = ',';
+        } else {
+            out = append_text(out, ",\"", 2);
+            out = append_text(out, field.name, std::strlen(field.name));
+            out = append_text(out, "\":", 2);
+        }
+        out = number(out, data.*field.member);
+    }
+    if (!csv) *out++ = '}';
+    if (format_ != SERIES_JSON) *out++ = '\n';
+    emit(line, (size_t)(out - line));
+    ++rows_;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void SeriesWriter::end() {
+    if (format_ == SERIES_JSON) emit(rows_ ? "\n]\n" : "]\n", rows_ ? 3 : 2);
+    if (!buffer_) flush_output();
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+char* SeriesWriter::number(char* out, double value) const {
+    if (!std::isfinite(value)) {
+        return format_ == SERIES_CSV ? out : append_text(out, "null", 4);
+    }
+    return grisu2::to_chars(out, value);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void SeriesWriter::emit(const char* data, size_t length) {
+    if (buffer_) buffer_->append(data, length);
+    else if (g_stdout_sink) g_stdout_sink->write_block(data, length);
+    else std::cout.write(data, (std::streamsize)length);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Streams the pi_cycle rows with from_ms <= open_time <= to_ms through `writer`. Returns the number of
+// rows written, or -1 on error.
+long long export_pi_cycle(sqlite3* db, long long from_ms, long long to_ms, SeriesWriter& writer) {
+    const char* query = R"(
+        SELECT open_time, price, ma_365, std_365, ceiling, median, floor, step, change, move, offset, weeks_52
+        FROM pi_cycle
+        WHERE open_time BETWEEN ? AND ?
+        ORDER BY open_time ASC;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, from_ms);
+    sqlite3_bind_int64(stmt, 2, to_ms);
+    writer.begin();
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        writer.row(read_pi_cycle_row(stmt));
+    }
+    sqlite3_finalize(stmt);
+    writer.end();
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Error: pi_cycle export failed: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    return (long long)writer.rows();
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Same for a mapped or loaded series, computing each row from a PiCycleIndex
+long long export_series(PriceSeriesView series, EpochDay from, EpochDay to, SeriesWriter& writer) {
+    PiCycleIndex index;
+    index.build(series);
+    size_t begin, end;
+    index.rows_for_days(from, to, begin, end);
+    writer.begin();
+    for (size_t i = begin; i < end; ++i) writer.row(index.row(i));
+    writer.end();
+    return (long long)writer.rows();
+}
+
+// --- Live Quotes ---
+/*----------------------------------------------------------------------------------------------------*/
+// Venue table under the indicator table; prices with the partition's `decimals`
+void print_live_quotes(const std::vector<VenueQuote>& quotes, const MergedQuote& merged, int decimals) {
+    const int places = std::max(2, decimals);
+    auto fixed_text = [places](double value) {
+        char buffer[512];
+        return std::string(buffer, format_fixed(value, places, true, buffer));
+    };
+    auto price_text = [&fixed_text](double value) { return value > 0 ? fixed_text(value) : std::string("-"); };
+    const double reference = quotes.empty() ? 0.0 : quotes[QUOTE_BINANCE].ticker.last;
+
+    std::cout << "+------------+----------------+----------------+----------------+------------+" << std::endl;
+    std::cout << "|   Venue    |      Bid       |      Ask       |      Last      | vs Binance |" << std::endl;
+    std::cout << "+------------+----------------+----------------+----------------+------------+" << std::endl;
+    for (const auto& quote : quotes) {
+        const Ticker& ticker = quote.ticker;
+        std::string versus = "-";
+        if (ticker.last > 0 && reference > 0) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%+.3f%%", (ticker.last - reference) / reference * 100.0);
+            versus = text;
+        }
+        std::cout << "| " << std::left << std::setw(10) << quote.venue << std::right
+                  << " | " << std::setw(14) << price_text(ticker.bid)
+                  << " | " << std::setw(14) << price_text(ticker.ask)
+                  << " | " << std::setw(14) << price_text(ticker.last)
+                  << " | " << std::setw(10) << versus << " |" << std::endl;
+    }
+    std::cout << "+------------+----------------+----------------+----------------+------------+" << std::endl;
+    if (!(merged.price > 0)) {
+        std::cout << "| No live Binance quote; the newest row is the stored candle." << std::endl;
+        return;
+    }
+    std::cout << "| Live price " << fixed_text(merged.price) << " (Binance last)";
+    if (merged.venues > 1) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f%%", merged.spread_pct);
+        std::cout << ", cross-exchange spread " << fixed_text(merged.spread) << " (" << text << ")";
+    }
+    std::cout << std::endl;
+    if (merged.bid_venue && merged.ask_venue) {
+        std::cout << "| Best bid " << fixed_text(merged.best_bid) << " (" << merged.bid_venue << "), best ask "
+                  << fixed_text(merged.best_ask) << " (" << merged.ask_venue << ")"
+                  << (merged.best_bid > merged.best_ask ? ", crossed" : "") << std::endl;
+    }
+}
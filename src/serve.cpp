@@ -0,0 +1,489 @@
+#include "binance_klines/serve.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/render.hpp"
+#include "binance_klines/watch.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <climits>
+#include <cstdio>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+// For the band server (Linux epoll, TCP and Unix sockets)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Band Server ---
+
+const size_t SERVE_MAX_REQUEST_BYTES = 8192;
+const int    SERVE_MAX_EVENTS        = 64;
+
+struct BandSeries {
+    KlineStore    store;
+    sqlite3_stmt* data_version_stmt = nullptr;
+    long long     data_version      = -1;
+    KlineColumns  columns;
+    PiCycleIndex  index;
+
+    ~BandSeries() { sqlite3_finalize(data_version_stmt); } // Before the store closes
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// Value of `name` in a query string ("a=1&b=2"), or "" when absent. Values are used undecoded.
+std::string query_param(const std::string& query, const char* name) {
+    const size_t name_length = std::strlen(name);
+    size_t position = 0;
+    while (position <= query.size()) {
+        size_t end = query.find('&', position);
+        if (end == std::string::npos) end = query.size();
+        if (end - position > name_length && query.compare(position, name_length, name) == 0 && query[position + name_length] == '=') {
+            return query.substr(position + name_length + 1, end - position - name_length - 1);
+        }
+        position = end + 1;
+    }
+    return "";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// True if the header block contains "Connection: close" (any case)
+bool wants_close(const char* headers, size_t length) {
+    static const char needle[] = "\r\nconnection: close";
+    const size_t needle_length = sizeof(needle) - 1;
+    for (size_t i = 0; i + needle_length <= length; ++i) {
+        size_t j = 0;
+        while (j < needle_length && std::tolower(static_cast<unsigned char>(headers[i + j])) == needle[j]) ++j;
+        if (j == needle_length) return true;
+    }
+    return false;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+class BandServer {
+public:
+    explicit BandServer(KlineCatalog& catalog) : catalog_(catalog) {}
+    BandServer(const BandServer&) = delete;
+    BandServer& operator=(const BandServer&) = delete;
+
+    ~BandServer() {
+        for (const auto& connection : connections_) ::close(connection.first);
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+        if (!unix_path_.empty()) unlink(unix_path_.c_str());
+    }
+
+    // A port number binds 127.0.0.1; anything else is the path of a Unix socket, which may replace only
+    // a stale socket file
+    bool listen(const std::string& address) {
+        const bool tcp = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+        listen_fd_ = ::socket(tcp ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int rc = -1;
+        if (listen_fd_ >= 0 && tcp) {
+            int reuse = 1;
+            setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            struct sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((uint16_t)std::atoi(address.c_str()));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            rc = ::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        } else if (listen_fd_ >= 0) {
+            struct sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            struct stat existing;
+            if (lstat(address.c_str(), &existing) == 0 && !S_ISSOCK(existing.st_mode)) {
+                // Never replace a regular file (e.g. a mistyped --serve binance.db)
+                std::cerr << "Error: Can't listen on " << address << ": the path exists and is not a socket." << std::endl;
+                return false;
+            } else if (address.size() < sizeof(addr.sun_path)) {
+                std::memcpy(addr.sun_path, address.c_str(), address.size());
+                unlink(address.c_str()); // A socket file left by an earlier server
+                rc = ::bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+                if (rc == 0) unix_path_ = address;
+            } else {
+                errno = ENAMETOOLONG;
+            }
+        }
+        if (rc == 0) rc = ::listen(listen_fd_, SOMAXCONN);
+        if (rc == 0) {
+            epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+            rc = epoll_fd_ >= 0 ? watch(listen_fd_, EPOLLIN, EPOLL_CTL_ADD) : -1;
+        }
+        if (rc != 0) {
+            std::cerr << "Error: Can't listen on " << address << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        tcp_ = tcp;
+        return true;
+    }
+
+    // Serves until SIGINT/SIGTERM or until `stop` becomes true
+    void run(const std::atomic<bool>* stop = nullptr) {
+        struct epoll_event events[SERVE_MAX_EVENTS];
+        while (!g_stop_requested && !(stop && stop->load())) {
+            int count = epoll_wait(epoll_fd_, events, SERVE_MAX_EVENTS, 100);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int e = 0; e < count; ++e) {
+                const int fd = events[e].data.fd;
+                if (fd == listen_fd_) {
+                    accept_clients();
+                    continue;
+                }
+                auto it = connections_.find(fd);
+                if (it == connections_.end()) continue;
+                bool open = (events[e].events & (EPOLLERR | EPOLLHUP)) == 0;
+                if (open && (events[e].events & EPOLLIN)) open = read_client(fd, it->second);
+                if (open) open = write_client(fd, it->second);
+                if (!open) {
+                    ::close(fd); // Also removes it from the epoll set
+                    connections_.erase(it);
+                }
+            }
+        }
+    }
+
+    unsigned long long requests() const { return requests_; }
+    unsigned long long reloads() const { return reloads_; }
+
+private:
+    struct Connection {
+        std::string input;
+        std::string output;
+        size_t      sent            = 0;
+        bool        writing         = false; // EPOLLOUT requested
+        bool        close_when_done = false; // Reply sent with Connection: close
+    };
+
+    int watch(int fd, uint32_t events, int operation) {
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epoll_fd_, operation, fd, &event);
+    }
+
+    void accept_clients() {
+        for (;;) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return; // EAGAIN: accepted everything pending
+            if (tcp_) {
+                int nodelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+            }
+            if (watch(fd, EPOLLIN, EPOLL_CTL_ADD) != 0) {
+                ::close(fd);
+                continue;
+            }
+            connections_[fd];
+        }
+    }
+
+    // Reads what is available and answers every complete request. False when the client is gone.
+    bool read_client(int fd, Connection& connection) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                connection.input.append(buffer, (size_t)received);
+                continue;
+            }
+            if (received == 0) return false;
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+
+        size_t consumed = 0;
+        while (!connection.close_when_done) {
+            const size_t end = connection.input.find("\r\n\r\n", consumed);
+            if (end == std::string::npos) break;
+            handle_request(connection.input.data() + consumed, end - consumed, connection);
+            consumed = end + 4;
+        }
+        connection.input.erase(0, consumed);
+        if (connection.input.size() > SERVE_MAX_REQUEST_BYTES) {
+            respond(connection, 431, "Request Header Fields Too Large", "{\"error\":\"request too large\"}", false);
+            connection.input.clear();
+        }
+        return true;
+    }
+
+    // Sends pending output. False when the connection should be closed.
+    bool write_client(int fd, Connection& connection) {
+        while (connection.sent < connection.output.size()) {
+            ssize_t written = ::send(fd, connection.output.data() + connection.sent, connection.output.size() - connection.sent, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                if (!connection.writing) connection.writing = watch(fd, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD) == 0;
+                return true;
+            }
+            connection.sent += (size_t)written;
+        }
+        connection.output.clear(); // Keeps its capacity for the next reply
+        connection.sent = 0;
+        if (connection.writing) {
+            watch(fd, EPOLLIN, EPOLL_CTL_MOD);
+            connection.writing = false;
+        }
+        return !connection.close_when_done;
+    }
+
+    void handle_request(const char* request, size_t length, Connection& connection) {
+        ++requests_;
+        const char* line_end = static_cast<const char*>(std::memchr(request, '\r', length));
+        const std::string line(request, line_end ? (size_t)(line_end - request) : length);
+        const bool keep_alive = line.compare(line.size() < 8 ? 0 : line.size() - 8, 8, "HTTP/1.1") == 0
+                                && !wants_close(request, length);
+
+        const size_t target_begin = line.find(' ');
+        const size_t target_end = line.find(' ', target_begin + 1);
+        if (line.compare(0, 4, "GET ") != 0 || target_end == std::string::npos) {
+            respond(connection, 405, "Method Not Allowed", "{\"error\":\"only GET is supported\"}", false);
+            return;
+        }
+        const std::string target = line.substr(target_begin + 1, target_end - target_begin - 1);
+        const size_t question = target.find('?');
+        const std::string path = target.substr(0, question);
+        const std::string query = question == std::string::npos ? "" : target.substr(question + 1);
+        if (path != "/bands") {
+            respond(connection, 404, "Not Found", "{\"error\":\"unknown path; use /bands?symbol=&from=&to=\"}", keep_alive);
+            return;
+        }
+
+        std::string symbol = query_param(query, "symbol");
+        if (symbol.empty()) symbol = g_symbol;
+        std::transform(symbol.begin(), symbol.end(), symbol.begin(), ::toupper);
+        const std::string from_text = query_param(query, "from");
+        const std::string to_text = query_param(query, "to");
+        EpochDay from = INT32_MIN, to = INT32_MAX;
+        if ((!from_text.empty() && !parse_ymd(from_text, from)) || (!to_text.empty() && !parse_ymd(to_text, to))) {
+            respond(connection, 400, "Bad Request", "{\"error\":\"from and to must be YYYY-MM-DD\"}", keep_alive);
+            return;
+        }
+        BandSeries* series = band_series(symbol);
+        if (!series) {
+            // The symbol is client input and is not echoed into the JSON body
+            respond(connection, 404, "Not Found", "{\"error\":\"no " + g_interval + " partition for the requested symbol\"}", keep_alive);
+            return;
+        }
+
+        body_.clear();
+        SeriesWriter writer(SERIES_JSON, &body_);
+        writer.begin();
+        if (from_text.empty() && to_text.empty()) {
+            if (series->index.size() > 0) writer.row(series->index.row(series->index.size() - 1));
+        } else {
+            size_t begin, end;
+            series->index.rows_for_days(from, to, begin, end);
+            for (size_t i = begin; i < end; ++i) writer.row(series->index.row(i));
+        }
+        writer.end();
+        respond(connection, 200, "OK", body_, keep_alive);
+    }
+
+    void respond(Connection& connection, int status, const char* reason, const std::string& body, bool keep_alive) {
+        char header[192];
+        int length = std::snprintf(header, sizeof(header),
+                                   "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%s\r\n",
+                                   status, reason, body.size(), keep_alive ? "" : "Connection: close\r\n");
+        connection.output.append(header, (size_t)length);
+        connection.output += body;
+        if (!keep_alive) connection.close_when_done = true;
+    }
+
+    // The cached series of `symbol`, reloaded first if its partition changed; nullptr if there is none
+    BandSeries* band_series(const std::string& symbol) {
+        auto it = cache_.find(symbol);
+        if (it == cache_.end()) {
+            std::string path;
+            for (const auto& partition : catalog_.partitions()) {
+                if (partition.symbol == symbol && partition.interval == g_interval) path = partition.path;
+            }
+            struct stat st;
+            if (path.empty() || stat(path.c_str(), &st) != 0) return nullptr;
+            std::unique_ptr<BandSeries> series(new BandSeries());
+            if (!series->store.open(path)
+                || sqlite3_prepare_v2(series->store.db(), "PRAGMA data_version;", -1, &series->data_version_stmt, 0) != SQLITE_OK) {
+                return nullptr;
+            }
+            it = cache_.insert(std::make_pair(symbol, std::move(series))).first;
+        }
+
+        BandSeries& series = *it->second;
+        long long version = -1;
+        if (sqlite3_step(series.data_version_stmt) == SQLITE_ROW) version = sqlite3_column_int64(series.data_version_stmt, 0);
+        sqlite3_reset(series.data_version_stmt);
+        if (version != series.data_version) {
+            auto start = std::chrono::steady_clock::now();
+            series.columns = load_kline_columns(series.store.db(), KLINE_OPEN_TIME | KLINE_PRICE);
+            series.index.build(price_series_view(series.columns));
+            series.data_version = version;
+            ++reloads_;
+            if (g_debug_enabled) {
+                std::cout << "Debug: Loaded " << series.columns.size << " " << symbol << " " << g_interval << " klines in "
+                          << std::fixed << std::setprecision(2) << elapsed_ms(start) << " ms." << std::endl;
+            }
+        }
+        return &series;
+    }
+
+    KlineCatalog&                                      catalog_;
+    int                                                listen_fd_ = -1;
+    int                                                epoll_fd_  = -1;
+    bool                                               tcp_       = false;
+    std::string                                        unix_path_;
+    std::map<int, Connection>                          connections_;
+    std::map<std::string, std::unique_ptr<BandSeries>> cache_;
+    std::string                                        body_; // Reused for every reply
+    unsigned long long                                 requests_ = 0;
+    unsigned long long                                 reloads_  = 0;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+int run_band_server(KlineCatalog& catalog, const std::string& address) {
+    BandServer server(catalog);
+    if (!server.listen(address)) return 1;
+    install_stop_handlers();
+    std::cout << "Serving /bands?symbol=&from=&to= for " << g_interval << " partitions on "
+              << (address.find_first_not_of("0123456789") == std::string::npos ? "127.0.0.1:" : "") << address
+              << " (Ctrl-C to stop)." << std::endl;
+    flush_output();
+    server.run();
+    std::cout << "Answered " << server.requests() << " requests (" << server.reloads() << " series loads)." << std::endl;
+    return 0;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Sends `request` on a blocking connection and reads one whole response. False on a broken connection.
+bool http_round_trip(int fd, const std::string& request, std::string& response) {
+    if (!write_all(fd, request.data(), request.size())) return false;
+    response.clear();
+    size_t header_end = std::string::npos;
+    size_t total = 0;
+    char buffer[16384];
+    for (;;) {
+        if (header_end == std::string::npos) {
+            header_end = response.find("\r\n\r\n");
+            if (header_end != std::string::npos) {
+                const size_t field = response.find("Content-Length: ");
+                if (field == std::string::npos || field > header_end) return false;
+                total = header_end + 4 + (size_t)std::atoll(response.c_str() + field + 16);
+            }
+        }
+        if (header_end != std::string::npos && response.size() >= total) return true;
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            if (received < 0 && errno == EINTR) continue;
+            return false;
+        }
+        response.append(buffer, (size_t)received);
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Load test: starts a BandServer on a scratch Unix socket and has `clients` keep-alive connections
+// send `requests` GETs in total, for the newest row and for a 30-day range, reporting throughput
+// and latency percentiles.
+void run_serve_benchmark(KlineCatalog& catalog, int requests, int clients) {
+    const std::string socket_path = "/tmp/pi-cycle-bench-" + std::to_string(getpid()) + ".sock";
+    BandServer server(catalog);
+    if (!server.listen(socket_path)) return;
+    std::atomic<bool> stop(false);
+    std::thread loop([&]() { server.run(&stop); });
+
+    char from_text[DATE_BUFFER_SIZE];
+    format_ymd(current_epoch_day() - 30, from_text);
+    const std::string targets[2] = {"/bands?symbol=" + g_symbol, "/bands?symbol=" + g_symbol + "&from=" + from_text};
+    const char* names[2] = {"newest row", "30-day range"};
+
+    std::cout << "Band server benchmark: " << requests << " requests over " << clients << " connections, " << g_symbol
+              << " " << g_interval << std::endl;
+    std::cout << "+--------------+------------+----------+----------+----------+----------+----------+" << std::endl;
+    std::cout << "| Query        |  Req/s     | p50 (us) | p90 (us) | p99 (us) | p99.9 us | max (us) |" << std::endl;
+    std::cout << "+--------------+------------+----------+----------+----------+----------+----------+" << std::endl;
+    for (int t = 0; t < 2; ++t) {
+        const std::string request = "GET " + targets[t] + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        const int per_client = std::max(1, requests / clients);
+        std::vector<std::vector<double>> latencies(clients);
+        std::atomic<int> failures(0);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> pool;
+        for (int c = 0; c < clients; ++c) {
+            pool.emplace_back([&, c]() {
+                int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                struct sockaddr_un addr;
+                std::memset(&addr, 0, sizeof(addr));
+                addr.sun_family = AF_UNIX;
+                std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+                if (fd < 0 || ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+                    ++failures;
+                    if (fd >= 0) ::close(fd);
+                    return;
+                }
+                std::string response;
+                latencies[c].reserve(per_client);
+                if (!http_round_trip(fd, request, response)) ++failures; // Untimed: the first one may load the series
+                for (int r = 0; r < per_client; ++r) {
+                    auto sent = std::chrono::steady_clock::now();
+                    if (!http_round_trip(fd, request, response) || response.compare(0, 12, "HTTP/1.1 200") != 0) {
+                        ++failures;
+                        break;
+                    }
+                    latencies[c].push_back(elapsed_ms(sent) * 1000.0);
+                }
+                ::close(fd);
+            });
+        }
+        for (auto& thread : pool) thread.join();
+        const double seconds = elapsed_ms(start) / 1000.0;
+
+        std::vector<double> all;
+        for (const auto& client : latencies) all.insert(all.end(), client.begin(), client.end());
+        std::sort(all.begin(), all.end());
+        auto percentile = [&](double p) { return all.empty() ? 0.0 : all[std::min(all.size() - 1, (size_t)(p * all.size()))]; };
+        std::cout << "| " << std::setw(12) << std::left << names[t] << std::right << std::fixed << std::setprecision(1)
+                  << " | " << std::setw(10) << std::setprecision(0) << all.size() / seconds << std::setprecision(1)
+                  << " | " << std::setw(8) << percentile(0.50)
+                  << " | " << std::setw(8) << percentile(0.90)
+                  << " | " << std::setw(8) << percentile(0.99)
+                  << " | " << std::setw(8) << percentile(0.999)
+                  << " | " << std::setw(8) << (all.empty() ? 0.0 : all.back()) << " |" << std::endl;
+        if (failures > 0) {
+            std::cerr << "Error: " << failures << " connections failed during the " << names[t] << " run." << std::endl;
+        }
+    }
+    std::cout << "+--------------+------------+----------+----------+----------+----------+----------+" << std::endl;
+    stop = true;
+    loop.join();
+}
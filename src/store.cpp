@@ -0,0 +1,946 @@
+#include "binance_klines/store.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/parse.hpp"
+#include "binance_klines/indicators.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <climits>
+
+// For SQLite
+#include <sqlite3.h>
+
+// --- Klines Table ---
+/*----------------------------------------------------------------------------------------------------*/
+std::string klines_table_sql(const std::string& table_name) {
+    return "CREATE TABLE IF NOT EXISTS " + table_name + R"( (
+            open_time              INTEGER PRIMARY KEY, -- Kline open time (ms since epoch, UTC)
+            price                  INTEGER,             -- Prices in ticks (see kline_scale)
+            open                   INTEGER,
+            high                   INTEGER,
+            low                    INTEGER,
+            close                  INTEGER,
+            volume                 REAL,
+            num_trades             INTEGER,
+            close_time             INTEGER,             -- Kline close time (ms since epoch, UTC)
+            quote_volume           REAL,
+            taker_buy_base_volume  REAL,
+            taker_buy_quote_volume REAL
+        ) WITHOUT ROWID;
+    )";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool exec_sql(sqlite3* db, const std::string& sql, const char* context) {
+    char* err_msg = 0;
+    int rc = sqlite3_exec(db, sql.c_str(), 0, 0, &err_msg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error (" << context << "): " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+        return false;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+int get_schema_version(sqlite3* db) {
+    sqlite3_stmt* stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool table_exists(sqlite3* db, const std::string& table_name) {
+    sqlite3_stmt* stmt;
+    bool exists = false;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, table_name.c_str(), -1, SQLITE_STATIC);
+        exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Rewrites a legacy (version 1) table in place: the rows are copied into a WITHOUT ROWID table
+// keyed on open_time, the old table and its UNIQUE index are dropped and the new one takes its name.
+// The columns the legacy layout never stored are left NULL until the next fetch fills them in.
+bool migrate_klines_from_v1(sqlite3* db) {
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "migrate_klines_from_v1")) return false;
+
+    bool ok = exec_sql(db, klines_table_sql("klines_migrated"), "migrate_klines_from_v1")
+           && exec_sql(db, R"(
+                  INSERT OR REPLACE INTO klines_migrated (open_time, price, open, high, low, close, volume, num_trades)
+                  SELECT CAST(strftime('%s', dt1) AS INTEGER) * 1000, price, open, high, low, close, volume, num_trades
+                  FROM klines
+                  WHERE dt1 IS NOT NULL;
+              )", "migrate_klines_from_v1");
+    int migrated_rows = sqlite3_changes(db);
+
+    ok = ok && exec_sql(db, "DROP TABLE klines;", "migrate_klines_from_v1")
+            && exec_sql(db, "ALTER TABLE klines_migrated RENAME TO klines;", "migrate_klines_from_v1")
+            && exec_sql(db, "PRAGMA user_version = 3;", "migrate_klines_from_v1");
+
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "migrate_klines_from_v1");
+        return false;
+    }
+    if (!exec_sql(db, "COMMIT;", "migrate_klines_from_v1")) return false;
+
+    std::cout << "Migrated " << migrated_rows << " rows in table 'klines' to schema version 3." << std::endl;
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Version 2 -> 3 only adds nullable columns, which SQLite does without rewriting the table.
+bool migrate_klines_v2_to_v3(sqlite3* db) {
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "migrate_klines_v2_to_v3")) return false;
+
+    bool ok = exec_sql(db, "ALTER TABLE klines ADD COLUMN close_time INTEGER;", "migrate_klines_v2_to_v3")
+           && exec_sql(db, "ALTER TABLE klines ADD COLUMN quote_volume REAL;", "migrate_klines_v2_to_v3")
+           && exec_sql(db, "ALTER TABLE klines ADD COLUMN taker_buy_base_volume REAL;", "migrate_klines_v2_to_v3")
+           && exec_sql(db, "ALTER TABLE klines ADD COLUMN taker_buy_quote_volume REAL;", "migrate_klines_v2_to_v3")
+           && exec_sql(db, "PRAGMA user_version = 3;", "migrate_klines_v2_to_v3");
+
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "migrate_klines_v2_to_v3");
+        return false;
+    }
+    if (!exec_sql(db, "COMMIT;", "migrate_klines_v2_to_v3")) return false;
+
+    std::cout << "Migrated table 'klines' to schema version 3." << std::endl;
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The pi_cycle table holds one row of computed indicators per kline day. pi_cycle_state.dirty_from is
+// the earliest open_time whose inputs changed since the last compute (NULL when up to date); the
+// triggers keep it current for every writer of klines, including the standalone fetcher. A change in
+// PI_CYCLE_ALGORITHM_VERSION invalidates every stored row.
+std::string pi_cycle_tables_sql() {
+    return R"(
+        CREATE TABLE IF NOT EXISTS pi_cycle (
+            open_time INTEGER PRIMARY KEY, -- Same key as klines
+            price     REAL,
+            ma_365    REAL,
+            std_365   REAL,
+            ceiling   REAL,
+            median    REAL,
+            floor     REAL,
+            step      REAL,
+            change    REAL,
+            move      REAL,
+            offset    REAL,
+            weeks_52  REAL
+        ) WITHOUT ROWID;
+
+        CREATE TABLE IF NOT EXISTS pi_cycle_state (
+            id                INTEGER PRIMARY KEY CHECK (id = 1),
+            dirty_from        INTEGER,
+            algorithm_version INTEGER
+        );
+        INSERT OR IGNORE INTO pi_cycle_state (id, dirty_from, algorithm_version)
+        SELECT 1, MIN(open_time), 0 FROM klines;
+
+        CREATE TRIGGER IF NOT EXISTS klines_pi_cycle_insert AFTER INSERT ON klines
+        BEGIN
+            UPDATE pi_cycle_state SET dirty_from = MIN(COALESCE(dirty_from, NEW.open_time), NEW.open_time) WHERE id = 1;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS klines_pi_cycle_update AFTER UPDATE OF price ON klines
+        WHEN OLD.price IS NOT NEW.price
+        BEGIN
+            UPDATE pi_cycle_state SET dirty_from = MIN(COALESCE(dirty_from, NEW.open_time), NEW.open_time) WHERE id = 1;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS klines_pi_cycle_delete AFTER DELETE ON klines
+        BEGIN
+            UPDATE pi_cycle_state SET dirty_from = MIN(COALESCE(dirty_from, OLD.open_time), OLD.open_time) WHERE id = 1;
+        END;
+    )";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// price_factor duplicates 10^price_decimals so plain SQL can read prices as price * 1.0 / price_factor.
+std::string kline_scale_table_sql() {
+    return R"(
+        CREATE TABLE IF NOT EXISTS kline_scale (
+            id             INTEGER PRIMARY KEY CHECK (id = 1),
+            price_decimals INTEGER NOT NULL,
+            price_factor   INTEGER NOT NULL
+        );
+    )";
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool migrate_klines_v3_to_v4(sqlite3* db) {
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "migrate_klines_v3_to_v4")) return false;
+
+    bool ok = exec_sql(db, pi_cycle_tables_sql(), "migrate_klines_v3_to_v4")
+           && exec_sql(db, "PRAGMA user_version = 4;", "migrate_klines_v3_to_v4");
+
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "migrate_klines_v3_to_v4");
+        return false;
+    }
+    return exec_sql(db, "COMMIT;", "migrate_klines_v3_to_v4");
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Fewest decimals that represent every stored REAL price exactly (up to float noise); the scale a
+// pre-version-5 table is converted with, since the exchange is not consulted during a migration.
+// Returns -1 for a table without prices: no scale can be inferred, and the first fetch records one.
+int infer_price_decimals(sqlite3* db) {
+    int decimals = 0;
+    bool priced = false;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT price, open, high, low, close FROM klines;", -1, &stmt, 0) != SQLITE_OK) {
+        return PRICE_MAX_DECIMALS;
+    }
+    while (decimals < PRICE_MAX_DECIMALS && sqlite3_step(stmt) == SQLITE_ROW) {
+        for (int c = 0; c < 5; ++c) {
+            if (sqlite3_column_type(stmt, c) == SQLITE_NULL) continue;
+            priced = true;
+            double value = sqlite3_column_double(stmt, c);
+            for (;;) {
+                double scaled = value * (double)PRICE_SCALES[decimals];
+                if (decimals == PRICE_MAX_DECIMALS || std::fabs(scaled - std::round(scaled)) <= 1e-9 * std::fabs(scaled) + 1e-6) break;
+                ++decimals;
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+    return priced ? decimals : -1;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Rebuilds klines with integer price columns. The triggers go with the old table and are recreated,
+// and the whole pi_cycle table is marked dirty since its inputs are re-read through the new scale.
+bool migrate_klines_v4_to_v5(sqlite3* db) {
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "migrate_klines_v4_to_v5")) return false;
+
+    int decimals = infer_price_decimals(db);
+    std::string factor = std::to_string(PRICE_SCALES[decimals < 0 ? 0 : decimals]);
+    std::string ticks_sql;
+    for (const char* column : {"price", "open", "high", "low", "close"}) {
+        ticks_sql += "CAST(ROUND(" + std::string(column) + " * " + factor + ") AS INTEGER), ";
+    }
+    bool ok = exec_sql(db, klines_table_sql("klines_fixed"), "migrate_klines_v4_to_v5")
+           && exec_sql(db, "INSERT INTO klines_fixed SELECT open_time, " + ticks_sql + R"(
+                                   volume, num_trades, close_time, quote_volume, taker_buy_base_volume, taker_buy_quote_volume
+                               FROM klines;)", "migrate_klines_v4_to_v5");
+    int migrated_rows = sqlite3_changes(db);
+
+    ok = ok && exec_sql(db, "DROP TABLE klines;", "migrate_klines_v4_to_v5")
+            && exec_sql(db, "ALTER TABLE klines_fixed RENAME TO klines;", "migrate_klines_v4_to_v5")
+            && exec_sql(db, pi_cycle_tables_sql(), "migrate_klines_v4_to_v5")
+            && exec_sql(db, "UPDATE pi_cycle_state SET dirty_from = (SELECT MIN(open_time) FROM klines) WHERE id = 1;",
+                        "migrate_klines_v4_to_v5")
+            && exec_sql(db, kline_scale_table_sql(), "migrate_klines_v4_to_v5")
+            && (decimals < 0
+                || exec_sql(db, "INSERT OR REPLACE INTO kline_scale (id, price_decimals, price_factor) VALUES (1, "
+                                + std::to_string(decimals) + ", " + factor + ");", "migrate_klines_v4_to_v5"))
+            && exec_sql(db, "PRAGMA user_version = 5;", "migrate_klines_v4_to_v5");
+
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "migrate_klines_v4_to_v5");
+        return false;
+    }
+    if (!exec_sql(db, "COMMIT;", "migrate_klines_v4_to_v5")) return false;
+
+    std::cout << "Migrated " << migrated_rows << " rows in table 'klines' to schema version 5 (";
+    if (decimals < 0) {
+        std::cout << "price decimals are recorded on the first fetch)." << std::endl;
+    } else {
+        std::cout << decimals << " price decimals)." << std::endl;
+    }
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void create_klines_table(sqlite3* db) {
+    int version = get_schema_version(db);
+
+    if (version == 0 && table_exists(db, "klines")) {
+        version = 1; // Tables created before versioning was introduced
+    }
+
+    if (version == 0) {
+        if (exec_sql(db, klines_table_sql("klines"), "create_klines_table")
+            && exec_sql(db, pi_cycle_tables_sql(), "create_klines_table")
+            && exec_sql(db, kline_scale_table_sql(), "create_klines_table")
+            && exec_sql(db, "PRAGMA user_version = " + std::to_string(KLINES_SCHEMA_VERSION) + ";", "create_klines_table")) {
+            if (g_debug_enabled) {
+                std::cout << "Debug: Table 'klines' created with schema version " << KLINES_SCHEMA_VERSION << "." << std::endl;
+            }
+        }
+        return;
+    }
+
+    bool migrated = true;
+    if (version == 1) {
+        migrated = migrate_klines_from_v1(db); // Rebuilds straight into the version 3 layout
+    } else if (version == 2) {
+        migrated = migrate_klines_v2_to_v3(db);
+    }
+    if (migrated && version < 4) {
+        migrated = migrate_klines_v3_to_v4(db);
+    }
+    if (migrated && version < 5) {
+        migrated = migrate_klines_v4_to_v5(db);
+    }
+    if (!migrated) {
+        std::cerr << "Error: Failed to migrate table 'klines' from schema version " << version << "." << std::endl;
+        return;
+    }
+
+    if (version > KLINES_SCHEMA_VERSION) {
+        std::cerr << "Warning: Database schema version " << version << " is newer than supported version "
+                  << KLINES_SCHEMA_VERSION << "." << std::endl;
+    } else if (g_debug_enabled) {
+        std::cout << "Debug: Table 'klines' checked successfully (schema version " << KLINES_SCHEMA_VERSION << ")." << std::endl;
+    }
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The partition's price decimals, or -1 before the first fetch has recorded them
+int stored_price_decimals(sqlite3* db) {
+    sqlite3_stmt* stmt;
+    int decimals = -1;
+    if (sqlite3_prepare_v2(db, "SELECT price_decimals FROM kline_scale WHERE id = 1;", -1, &stmt, 0) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        decimals = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return (decimals >= 0 && decimals <= PRICE_MAX_DECIMALS) ? decimals : -1;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Divisor that turns stored ticks into prices. A partition without a recorded scale only holds rows
+// written with the default (benchmarks), so that is assumed.
+double price_factor(sqlite3* db) {
+    int decimals = stored_price_decimals(db);
+    return (double)PRICE_SCALES[decimals < 0 ? PRICE_MAX_DECIMALS : decimals];
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Records the scale unless one is already there; only rescale_prices() changes it afterwards.
+bool store_price_decimals(sqlite3* db, int decimals) {
+    return exec_sql(db, "INSERT OR IGNORE INTO kline_scale (id, price_decimals, price_factor) VALUES (1, "
+                        + std::to_string(decimals) + ", " + std::to_string(PRICE_SCALES[decimals]) + ");",
+                    "store_price_decimals");
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Moves the partition to a finer tick: every stored price is multiplied by 10^(decimals - current)
+// and kline_scale is updated in the same transaction, so readers never see rows and scale disagree.
+// A tick no finer than the recorded one needs no change; its prices already lie on the stored grid.
+bool rescale_prices(sqlite3* db, int decimals) {
+    int current = stored_price_decimals(db);
+    if (decimals < 0 || decimals > PRICE_MAX_DECIMALS) return false;
+    if (current < 0) return store_price_decimals(db, decimals);
+    if (decimals <= current) return true;
+
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "rescale_prices")) return false;
+
+    std::string multiplier = std::to_string(PRICE_SCALES[decimals - current]);
+    std::string assignments;
+    for (const char* column : {"price", "open", "high", "low", "close"}) {
+        if (!assignments.empty()) assignments += ", ";
+        assignments += std::string(column) + " = " + column + " * " + multiplier;
+    }
+    bool ok = exec_sql(db, "UPDATE klines SET " + assignments + ";", "rescale_prices");
+    int rescaled_rows = sqlite3_changes(db);
+    ok = ok && exec_sql(db, "INSERT OR REPLACE INTO kline_scale (id, price_decimals, price_factor) VALUES (1, "
+                            + std::to_string(decimals) + ", " + std::to_string(PRICE_SCALES[decimals]) + ");",
+                        "rescale_prices");
+
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "rescale_prices");
+        return false;
+    }
+    if (!exec_sql(db, "COMMIT;", "rescale_prices")) return false;
+
+    std::cout << "Rescaled " << rescaled_rows << " rows in table 'klines' from " << current << " to "
+              << decimals << " price decimals." << std::endl;
+    return true;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+const char* KLINES_UPSERT_SQL = R"(
+    INSERT INTO klines (open_time, price, open, high, low, close, volume, num_trades,
+                        close_time, quote_volume, taker_buy_base_volume, taker_buy_quote_volume)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    ON CONFLICT(open_time) DO UPDATE SET
+        price                  = excluded.price,
+        open                   = excluded.open,
+        high                   = excluded.high,
+        low                    = excluded.low,
+        close                  = excluded.close,
+        volume                 = excluded.volume,
+        num_trades             = excluded.num_trades,
+        close_time             = excluded.close_time,
+        quote_volume           = excluded.quote_volume,
+        taker_buy_base_volume  = excluded.taker_buy_base_volume,
+        taker_buy_quote_volume = excluded.taker_buy_quote_volume;
+)";
+
+/*----------------------------------------------------------------------------------------------------*/
+void bind_kline(sqlite3_stmt* stmt, const Kline& kline) {
+    sqlite3_bind_int64(stmt, 1, kline.open_time);
+    sqlite3_bind_int64(stmt, 2, kline.price);
+    sqlite3_bind_int64(stmt, 3, kline.open);
+    sqlite3_bind_int64(stmt, 4, kline.high);
+    sqlite3_bind_int64(stmt, 5, kline.low);
+    sqlite3_bind_int64(stmt, 6, kline.close);
+    sqlite3_bind_double(stmt, 7, kline.volume);
+    sqlite3_bind_int(stmt, 8, kline.num_trades);
+    sqlite3_bind_int64(stmt, 9, kline.close_time);
+    sqlite3_bind_double(stmt, 10, kline.quote_volume);
+    sqlite3_bind_double(stmt, 11, kline.taker_buy_base_volume);
+    sqlite3_bind_double(stmt, 12, kline.taker_buy_quote_volume);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+bool same_kline(const Kline& a, const Kline& b) {
+    return a.open_time == b.open_time
+        && a.price == b.price
+        && a.open == b.open
+        && a.high == b.high
+        && a.low == b.low
+        && a.close == b.close
+        && a.volume == b.volume
+        && a.num_trades == b.num_trades
+        && a.close_time == b.close_time
+        && a.quote_volume == b.quote_volume
+        && a.taker_buy_base_volume == b.taker_buy_base_volume
+        && a.taker_buy_quote_volume == b.taker_buy_quote_volume;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Writes only the candles that are new or differ from what is stored. The stored rows covering the
+// batch are read with one range scan and compared field by field (prices are exact integer ticks),
+// so re-polling an unchanged history costs a read and no page writes. The newest candle in the table
+// carries its close as price (see update_current_date_price_with_close()); that is applied before
+// comparing so an unchanged live candle is skipped too.
+UpsertStats insert_klines_data(sqlite3* db, const std::vector<Kline>& klines) {
+    UpsertStats stats;
+    if (klines.empty()) return stats;
+
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "insert_klines_data")) return stats;
+
+    long long first_open_time = klines.front().open_time;
+    long long last_open_time  = klines.front().open_time;
+    for (const auto& kline : klines) {
+        first_open_time = std::min(first_open_time, kline.open_time);
+        last_open_time  = std::max(last_open_time, kline.open_time);
+    }
+
+    // Stored rows in the batch's range; rows with NULL columns (e.g. from the v1 migration) never match
+    std::map<long long, Kline> stored;
+    std::set<long long> incomplete;
+    long long stored_max_open_time = LLONG_MIN;
+    sqlite3_stmt* stmt;
+    const char* select_sql = R"(
+        SELECT open_time, price, open, high, low, close, volume, num_trades,
+               close_time, quote_volume, taker_buy_base_volume, taker_buy_quote_volume
+        FROM klines
+        WHERE open_time BETWEEN ? AND ?;
+    )";
+    if (sqlite3_prepare_v2(db, select_sql, -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, first_open_time);
+        sqlite3_bind_int64(stmt, 2, last_open_time);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Kline row;
+            row.open_time              = sqlite3_column_int64(stmt, 0);
+            row.price                  = sqlite3_column_int64(stmt, 1);
+            row.open                   = sqlite3_column_int64(stmt, 2);
+            row.high                   = sqlite3_column_int64(stmt, 3);
+            row.low                    = sqlite3_column_int64(stmt, 4);
+            row.close                  = sqlite3_column_int64(stmt, 5);
+            row.volume                 = sqlite3_column_double(stmt, 6);
+            row.num_trades             = sqlite3_column_int(stmt, 7);
+            row.close_time             = sqlite3_column_int64(stmt, 8);
+            row.quote_volume           = sqlite3_column_double(stmt, 9);
+            row.taker_buy_base_volume  = sqlite3_column_double(stmt, 10);
+            row.taker_buy_quote_volume = sqlite3_column_double(stmt, 11);
+            stored[row.open_time] = row;
+            for (int c = 1; c < 12; ++c) {
+                if (sqlite3_column_type(stmt, c) == SQLITE_NULL) incomplete.insert(row.open_time);
+            }
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (sqlite3_prepare_v2(db, "SELECT MAX(open_time) FROM klines;", -1, &stmt, 0) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        stored_max_open_time = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    int rc = sqlite3_prepare_v2(db, KLINES_UPSERT_SQL, -1, &stmt, 0);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        exec_sql(db, "ROLLBACK;", "insert_klines_data");
+        return stats;
+    }
+
+    for (const auto& incoming : klines) {
+        Kline kline = incoming;
+        if (kline.open_time == last_open_time && kline.open_time >= stored_max_open_time) {
+            kline.price = kline.close; // Will be the newest row in the table
+        }
+
+        auto existing = stored.find(kline.open_time);
+        bool is_new = (existing == stored.end());
+        if (!is_new && !incomplete.count(kline.open_time) && same_kline(existing->second, kline)) {
+            ++stats.skipped;
+            continue;
+        }
+
+        bind_kline(stmt, kline);
+        rc = sqlite3_step(stmt);
+        if (rc != SQLITE_DONE) {
+            std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
+        } else if (is_new) {
+            ++stats.inserted;
+        } else {
+            ++stats.updated;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    exec_sql(db, "COMMIT;", "insert_klines_data");
+    if (g_debug_enabled) {
+        std::cout << "Debug: Klines upserted: " << stats.inserted << " inserted, " << stats.updated
+                  << " updated, " << stats.skipped << " skipped." << std::endl;
+    }
+    return stats;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Reads only the requested columns (a mask of KlineColumn bits) in open_time order. Columns that
+// were not asked for are neither selected nor allocated, so a price-only consumer never pays for
+// the volume fields. Price columns are converted from ticks here, on their way to the kernels.
+KlineColumns load_kline_columns(sqlite3* db, unsigned columns) {
+    static const struct { unsigned bit; const char* name; } COLUMN_NAMES[] = {
+        {KLINE_OPEN_TIME,              "open_time"},
+        {KLINE_PRICE,                  "price"},
+        {KLINE_OPEN,                   "open"},
+        {KLINE_HIGH,                   "high"},
+        {KLINE_LOW,                    "low"},
+        {KLINE_CLOSE,                  "close"},
+        {KLINE_VOLUME,                 "volume"},
+        {KLINE_NUM_TRADES,             "num_trades"},
+        {KLINE_CLOSE_TIME,             "close_time"},
+        {KLINE_QUOTE_VOLUME,           "quote_volume"},
+        {KLINE_TAKER_BUY_BASE_VOLUME,  "taker_buy_base_volume"},
+        {KLINE_TAKER_BUY_QUOTE_VOLUME, "taker_buy_quote_volume"}
+    };
+
+    KlineColumns result;
+    result.columns = columns;
+
+    std::string select_list;
+    std::vector<unsigned> selected;
+    for (const auto& column : COLUMN_NAMES) {
+        if (columns & column.bit) {
+            select_list += (select_list.empty() ? "" : ", ") + std::string(column.name);
+            selected.push_back(column.bit);
+        }
+    }
+    if (selected.empty()) return result;
+
+    const double factor = price_factor(db);
+    std::string query = "SELECT " + select_list + " FROM klines ORDER BY open_time ASC;";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return result;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        for (int i = 0; i < (int)selected.size(); ++i) {
+            switch (selected[i]) {
+                case KLINE_OPEN_TIME:              result.open_time.push_back(sqlite3_column_int64(stmt, i)); break;
+                case KLINE_PRICE:                  result.price.push_back(sqlite3_column_int64(stmt, i) / factor); break;
+                case KLINE_OPEN:                   result.open.push_back(sqlite3_column_int64(stmt, i) / factor); break;
+                case KLINE_HIGH:                   result.high.push_back(sqlite3_column_int64(stmt, i) / factor); break;
+                case KLINE_LOW:                    result.low.push_back(sqlite3_column_int64(stmt, i) / factor); break;
+                case KLINE_CLOSE:                  result.close.push_back(sqlite3_column_int64(stmt, i) / factor); break;
+                case KLINE_VOLUME:                 result.volume.push_back(sqlite3_column_double(stmt, i)); break;
+                case KLINE_NUM_TRADES:             result.num_trades.push_back(sqlite3_column_int(stmt, i)); break;
+                case KLINE_CLOSE_TIME:             result.close_time.push_back(sqlite3_column_int64(stmt, i)); break;
+                case KLINE_QUOTE_VOLUME:           result.quote_volume.push_back(sqlite3_column_double(stmt, i)); break;
+                case KLINE_TAKER_BUY_BASE_VOLUME:  result.taker_buy_base_volume.push_back(sqlite3_column_double(stmt, i)); break;
+                case KLINE_TAKER_BUY_QUOTE_VOLUME: result.taker_buy_quote_volume.push_back(sqlite3_column_double(stmt, i)); break;
+            }
+        }
+        ++result.size;
+    }
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Open time and price for every row at or after `from_open_time`, preceded by up to `lookback_rows`
+// earlier rows. Both halves are range reads on the open_time primary key.
+KlineColumns load_price_window(sqlite3* db, long long from_open_time, int lookback_rows) {
+    KlineColumns result;
+    result.columns = KLINE_OPEN_TIME | KLINE_PRICE;
+    const double factor = price_factor(db);
+
+    const char* queries[2] = {
+        "SELECT open_time, price FROM klines WHERE open_time < ? ORDER BY open_time DESC LIMIT ?;",
+        "SELECT open_time, price FROM klines WHERE open_time >= ? ORDER BY open_time ASC;"
+    };
+    for (int q = 0; q < 2; ++q) {
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db, queries[q], -1, &stmt, 0) != SQLITE_OK) {
+            std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+            return result;
+        }
+        sqlite3_bind_int64(stmt, 1, from_open_time);
+        if (q == 0) sqlite3_bind_int(stmt, 2, lookback_rows);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            result.open_time.push_back(sqlite3_column_int64(stmt, 0));
+            result.price.push_back(sqlite3_column_int64(stmt, 1) / factor);
+        }
+        sqlite3_finalize(stmt);
+        if (q == 0) {
+            std::reverse(result.open_time.begin(), result.open_time.end());
+            std::reverse(result.price.begin(), result.price.end());
+        }
+    }
+    result.size = result.open_time.size();
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The newest `rows` open_time/price pairs in ascending order, read backwards along the primary key so
+// the cost depends on `rows` and not on the length of the history.
+KlineColumns load_price_tail(sqlite3* db, int rows) {
+    KlineColumns result;
+    result.columns = KLINE_OPEN_TIME | KLINE_PRICE;
+    const double factor = price_factor(db);
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT open_time, price FROM klines ORDER BY open_time DESC LIMIT ?;", -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return result;
+    }
+    sqlite3_bind_int(stmt, 1, rows);
+    result.open_time.reserve(rows);
+    result.price.reserve(rows);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        result.open_time.push_back(sqlite3_column_int64(stmt, 0));
+        result.price.push_back(sqlite3_column_int64(stmt, 1) / factor);
+    }
+    sqlite3_finalize(stmt);
+    std::reverse(result.open_time.begin(), result.open_time.end());
+    std::reverse(result.price.begin(), result.price.end());
+    result.size = result.open_time.size();
+    return result;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void update_current_date_price_with_close(sqlite3* db) {
+    char* err_msg = 0;
+    std::string sql = R"(
+        UPDATE klines
+        SET price = close
+        WHERE open_time = (SELECT MAX(open_time) FROM klines)
+          AND price IS NOT close;
+    )";
+    int rc = sqlite3_exec(db, sql.c_str(), 0, 0, &err_msg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error (update_current_date_price_with_close): " << err_msg << std::endl;
+        sqlite3_free(err_msg);
+    } else {
+        // Get the date that was updated for logging
+        sqlite3_stmt* stmt;
+        std::string select_max_date_sql = "SELECT date(MAX(open_time) / 1000, 'unixepoch') FROM klines;";
+        rc = sqlite3_prepare_v2(db, select_max_date_sql.c_str(), -1, &stmt, 0);
+        if (rc == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                const unsigned char* latest_date = sqlite3_column_text(stmt, 0);
+                if (latest_date) {
+                    if (g_debug_enabled) {
+                        std::cout << "Debug: Updated price with close price for latest date: " << latest_date << std::endl;
+                    }
+                } else {
+                    std::cout << "No records found to update in the klines table." << std::endl;
+                }
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+}
+
+// --- Partitioned Storage ---
+/*----------------------------------------------------------------------------------------------------*/
+void print_partitions(const KlineCatalog& catalog) {
+    sqlite3* reader = catalog.open_unified_reader();
+    if (!reader) return;
+    std::cout << "+------------+----------+----------+------------+------------+" << std::endl;
+    std::cout << "| Symbol     | Interval |   Rows   |   First    |    Last    |" << std::endl;
+    std::cout << "+------------+----------+----------+------------+------------+" << std::endl;
+    sqlite3_stmt* stmt;
+    const char* query = R"(
+        SELECT symbol, interval, COUNT(*), date(MIN(open_time) / 1000, 'unixepoch'), date(MAX(open_time) / 1000, 'unixepoch')
+        FROM all_klines GROUP BY symbol, interval ORDER BY symbol, interval;
+    )";
+    if (sqlite3_prepare_v2(reader, query, -1, &stmt, 0) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* first = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            const char* last  = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+            std::cout << "| " << std::setw(10) << std::left << sqlite3_column_text(stmt, 0)
+                      << " | " << std::setw(8) << sqlite3_column_text(stmt, 1) << std::right
+                      << " | " << std::setw(8) << sqlite3_column_int(stmt, 2)
+                      << " | " << std::setw(10) << (first ? first : "")
+                      << " | " << std::setw(10) << (last ? last : "") << " |" << std::endl;
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(reader);
+    std::cout << "+------------+----------+----------+------------+------------+" << std::endl;
+}
+
+// --- Series Loading ---
+/*----------------------------------------------------------------------------------------------------*/
+KlineColumns fetch_data(const std::string& db_path) {
+    KlineColumns klines_data;
+    sqlite3* db;
+    int rc = sqlite3_open(db_path.c_str(), &db);
+
+    if (rc) {
+        std::cerr << "Error: Can't open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return klines_data;
+    } else {
+        if (g_debug_enabled) {
+            std::cout << "Debug: Database opened successfully." << std::endl;
+        }
+    }
+
+    // Only the two columns the indicator engine reads; dates are formatted at display time
+    klines_data = load_kline_columns(db, KLINE_OPEN_TIME | KLINE_PRICE);
+
+    sqlite3_close(db);
+    if (g_debug_enabled) {
+        std::cout << "Debug: Fetched " << klines_data.size << " klines from database." << std::endl;
+    }
+    return klines_data;
+}
+
+// --- Gap Detection ---
+/*----------------------------------------------------------------------------------------------------*/
+// Holes between the first and last stored candle, plus (with include_tail) the candles between the
+// last stored one and the one in progress now.
+std::vector<KlineGap> find_kline_gaps(sqlite3* db, long long step_ms, bool include_tail) {
+    std::vector<KlineGap> gaps;
+    const char* query = R"(
+        SELECT open_time, next_open_time
+        FROM (SELECT open_time, LEAD(open_time) OVER (ORDER BY open_time) AS next_open_time FROM klines)
+        WHERE next_open_time - open_time > ?;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return gaps;
+    }
+    sqlite3_bind_int64(stmt, 1, step_ms);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        long long before = sqlite3_column_int64(stmt, 0);
+        long long after = sqlite3_column_int64(stmt, 1);
+        KlineGap gap = {before + step_ms, after - step_ms, (after - before) / step_ms - 1};
+        if (gap.missing > 0) gaps.push_back(gap);
+    }
+    sqlite3_finalize(stmt);
+
+    if (include_tail && sqlite3_prepare_v2(db, "SELECT MAX(open_time) FROM klines;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+            long long last = sqlite3_column_int64(stmt, 0);
+            long long current = current_open_time(step_ms);
+            if (current > last) {
+                KlineGap gap = {last + step_ms, current, (current - last) / step_ms};
+                gaps.push_back(gap);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    return gaps;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+std::string format_open_time(long long open_time_ms, long long step_ms) {
+    char buffer[DATE_BUFFER_SIZE + 6]; // "YYYY-MM-DD HH:MM"
+    EpochDay day = epoch_day(open_time_ms);
+    format_ymd(day, buffer);
+    if (step_ms < MS_PER_DAY) {
+        unsigned minute_of_day = (unsigned)((open_time_ms - epoch_day_to_ms(day)) / 60000LL);
+        buffer[10] = ' ';
+        write_two_digits(buffer + 11, minute_of_day / 60);
+        buffer[13] = ':';
+        write_two_digits(buffer + 14, minute_of_day % 60);
+        buffer[16] = '\0';
+    }
+    return buffer;
+}
+
+// --- Materialized Pi Cycle Table ---
+
+const int PI_CYCLE_ALGORITHM_VERSION = 1;   // Bump whenever price_projection()/add_calculated_fields() change
+
+/*----------------------------------------------------------------------------------------------------*/
+// Brings pi_cycle up to date: every row from pi_cycle_state.dirty_from onward is recomputed from the
+// klines it depends on and rewritten, and the mark is cleared, all in one transaction. Closed days
+// before the mark are never touched. Returns the number of rows written, or -1 on error.
+int refresh_pi_cycle(sqlite3* db, bool force_full) {
+    if (!exec_sql(db, "BEGIN IMMEDIATE TRANSACTION;", "refresh_pi_cycle")) return -1;
+
+    bool has_dirty = false;
+    long long dirty_from = 0;
+    int algorithm_version = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT dirty_from, algorithm_version FROM pi_cycle_state WHERE id = 1;", -1, &stmt, 0) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        has_dirty = sqlite3_column_type(stmt, 0) != SQLITE_NULL;
+        dirty_from = sqlite3_column_int64(stmt, 0);
+        algorithm_version = sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    if (force_full || algorithm_version != PI_CYCLE_ALGORITHM_VERSION) {
+        has_dirty = false;
+        if (sqlite3_prepare_v2(db, "SELECT MIN(open_time) FROM klines;", -1, &stmt, 0) == SQLITE_OK
+            && sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+            has_dirty = true;
+            dirty_from = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (!has_dirty) {
+        exec_sql(db, "COMMIT;", "refresh_pi_cycle");
+        return 0;
+    }
+
+    KlineColumns window = load_price_window(db, dirty_from, PI_CYCLE_LOOKBACK_ROWS);
+    std::vector<PiCycleData> pi_data = add_calculated_fields(price_projection(price_series_view(window)));
+
+    bool ok = true;
+    if (sqlite3_prepare_v2(db, "DELETE FROM pi_cycle WHERE open_time >= ?;", -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, dirty_from);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+    } else {
+        ok = false;
+    }
+    sqlite3_finalize(stmt);
+
+    int written = 0;
+    const char* insert_sql = R"(
+        INSERT INTO pi_cycle (open_time, price, ma_365, std_365, ceiling, median, floor, step, change, move, offset, weeks_52)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+    )";
+    if (ok && sqlite3_prepare_v2(db, insert_sql, -1, &stmt, 0) == SQLITE_OK) {
+        for (const auto& row : pi_data) {
+            if (row.open_time < dirty_from) continue; // Lookback rows are inputs only
+            sqlite3_bind_int64(stmt, 1, row.open_time);
+            sqlite3_bind_double(stmt, 2, row.price);
+            sqlite3_bind_double(stmt, 3, row.ma_365);
+            sqlite3_bind_double(stmt, 4, row.std_365);
+            sqlite3_bind_double(stmt, 5, row.ceiling);
+            sqlite3_bind_double(stmt, 6, row.median);
+            sqlite3_bind_double(stmt, 7, row.floor);
+            sqlite3_bind_double(stmt, 8, row.step);
+            sqlite3_bind_double(stmt, 9, row.change);
+            sqlite3_bind_double(stmt, 10, row.move);
+            sqlite3_bind_double(stmt, 11, row.offset);
+            sqlite3_bind_double(stmt, 12, row.weeks_52);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                std::cerr << "Execution failed: " << sqlite3_errmsg(db) << std::endl;
+                ok = false;
+                break;
+            }
+            sqlite3_reset(stmt);
+            ++written;
+        }
+    } else {
+        ok = false;
+    }
+    sqlite3_finalize(stmt);
+
+    ok = ok && exec_sql(db, "UPDATE pi_cycle_state SET dirty_from = NULL, algorithm_version = "
+                            + std::to_string(PI_CYCLE_ALGORITHM_VERSION) + " WHERE id = 1;", "refresh_pi_cycle");
+    if (!ok) {
+        exec_sql(db, "ROLLBACK;", "refresh_pi_cycle");
+        return -1;
+    }
+    if (!exec_sql(db, "COMMIT;", "refresh_pi_cycle")) return -1;
+
+    if (g_debug_enabled) {
+        std::cout << "Debug: Recomputed " << written << " pi_cycle rows from " << format_date(dirty_from) << "." << std::endl;
+    }
+    return written;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// One pi_cycle row from a statement selecting open_time, price, ma_365, std_365, ceiling, median,
+// floor, step, change, move, offset, weeks_52 in that order
+PiCycleData read_pi_cycle_row(sqlite3_stmt* stmt) {
+    PiCycleData row;
+    row.open_time    = sqlite3_column_int64(stmt, 0);
+    row.price        = sqlite3_column_double(stmt, 1);
+    row.ma_365       = sqlite3_column_double(stmt, 2);
+    row.std_365      = sqlite3_column_double(stmt, 3);
+    row.ceiling      = sqlite3_column_double(stmt, 4);
+    row.median       = sqlite3_column_double(stmt, 5);
+    row.floor        = sqlite3_column_double(stmt, 6);
+    row.dynamic_step = sqlite3_column_double(stmt, 7);
+    row.step         = row.dynamic_step;
+    row.change       = sqlite3_column_double(stmt, 8);
+    row.move         = sqlite3_column_double(stmt, 9);
+    row.offset       = sqlite3_column_double(stmt, 10);
+    row.weeks_52     = sqlite3_column_double(stmt, 11);
+    return row;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The newest `limit` rows of pi_cycle, newest first, in a single descending range read of the key.
+std::vector<PiCycleData> load_pi_cycle_latest(sqlite3* db, int limit) {
+    std::vector<PiCycleData> pi_data;
+    const char* query = R"(
+        SELECT open_time, price, ma_365, std_365, ceiling, median, floor, step, change, move, offset, weeks_52
+        FROM pi_cycle
+        ORDER BY open_time DESC
+        LIMIT ?;
+    )";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, 0) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return pi_data;
+    }
+    sqlite3_bind_int(stmt, 1, limit);
+    pi_data.reserve(limit);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        pi_data.push_back(read_pi_cycle_row(stmt));
+    }
+    sqlite3_finalize(stmt);
+    return pi_data;
+}
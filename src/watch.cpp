@@ -0,0 +1,239 @@
+#include "binance_klines/watch.hpp"
+#include "binance_klines/common.hpp"
+#include "binance_klines/output.hpp"
+#include "binance_klines/fetch.hpp"
+#include "binance_klines/store.hpp"
+#include "binance_klines/indicators.hpp"
+#include "binance_klines/render.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <thread>
+
+// For HTTP requests (libcurl)
+#include <curl/curl.h>
+
+// --- Watch Mode ---
+
+const int WATCH_FIRST_ROW_LINE = 5; // Title, rule, header, rule
+
+volatile std::sig_atomic_t g_stop_requested = 0; // Set by SIGINT/SIGTERM in the long-running modes
+
+/*----------------------------------------------------------------------------------------------------*/
+void request_stop(int) {
+    g_stop_requested = 1;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+void install_stop_handlers() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// The table as last drawn, so a frame only rewrites the cells that changed
+class WatchScreen {
+public:
+    explicit WatchScreen(size_t rows)
+        : cells_(rows * PI_TABLE_COLUMN_COUNT), colors_(rows, nullptr), redraw_(true) {
+        frame_.reserve(64 * 1024);
+    }
+
+    // Repaint everything next frame, e.g. after other output scrolled the terminal
+    void invalidate() { redraw_ = true; }
+
+    // Draws rows [0, dirty_rows) plus the title and status lines in a single write
+    void draw(const std::vector<PiCycleData>& rows, size_t dirty_rows, const std::string& title, const std::string& status) {
+        frame_.clear();
+        if (redraw_) {
+            frame_ += "\033[?25l\033[H\033[2J"; // Hide the cursor, clear the screen
+            frame_ += title;
+            frame_ += "\n";
+            frame_ += PI_TABLE_RULE;
+            frame_ += PI_TABLE_HEADER;
+            frame_ += PI_TABLE_RULE;
+            move_to(WATCH_FIRST_ROW_LINE + (int)rows.size(), 1);
+            frame_ += PI_TABLE_RULE;
+            std::fill(colors_.begin(), colors_.end(), nullptr);
+            dirty_rows = rows.size();
+        }
+        char cells[PI_TABLE_ROW_MAX_BYTES];
+        for (size_t r = 0; r < dirty_rows && r < rows.size(); ++r) {
+            // Cells wider than their column push the rest of the row right, so a change of any cell's
+            // length, like a change of color, repaints the whole row
+            const char* color = pi_row_color(rows[r]);
+            bool whole_row = color != colors_[r];
+            size_t begin[PI_TABLE_COLUMN_COUNT + 1] = {0};
+            for (size_t c = 0; c < PI_TABLE_COLUMN_COUNT; ++c) {
+                begin[c + 1] = (size_t)(render_pi_cell(cells + begin[c], rows[r], PI_TABLE_COLUMNS[c]) - cells);
+                whole_row = whole_row || cells_[r * PI_TABLE_COLUMN_COUNT + c].size() != begin[c + 1] - begin[c];
+            }
+            colors_[r] = color;
+            if (whole_row) {
+                char line[PI_TABLE_ROW_MAX_BYTES];
+                move_to(WATCH_FIRST_ROW_LINE + (int)r, 1);
+                frame_.append(line, (size_t)(render_pi_row(line, rows[r]) - line) - 1); // Without the newline
+                frame_ += "\033[K";
+            }
+            int column = 2; // After the leading '|'
+            for (size_t c = 0; c < PI_TABLE_COLUMN_COUNT; ++c) {
+                std::string& previous = cells_[r * PI_TABLE_COLUMN_COUNT + c];
+                const char* cell = cells + begin[c];
+                const size_t length = begin[c + 1] - begin[c];
+                if (whole_row || previous.compare(0, std::string::npos, cell, length) != 0) {
+                    if (!whole_row) {
+                        move_to(WATCH_FIRST_ROW_LINE + (int)r, column);
+                        frame_ += color;
+                        frame_.append(cell, length);
+                        frame_ += COLOR_RESET;
+                    }
+                    previous.assign(cell, length); // Reuses the string's capacity
+                }
+                column += (int)length + 2;
+            }
+        }
+        move_to(WATCH_FIRST_ROW_LINE + (int)rows.size() + 1, 1);
+        frame_ += status;
+        frame_ += "\033[K\n";
+        redraw_ = false;
+
+        if (g_stdout_sink) {
+            g_stdout_sink->write_block(frame_.data(), frame_.size());
+            g_stdout_sink->flush();
+        } else {
+            std::cout.write(frame_.data(), (std::streamsize)frame_.size());
+            std::cout.flush();
+        }
+    }
+
+private:
+    void move_to(int line, int column) {
+        char escape[32];
+        frame_.append(escape, (size_t)std::snprintf(escape, sizeof(escape), "\033[%d;%dH", line, column));
+    }
+
+    std::vector<std::string> cells_;  // Cell text per row and column as on screen
+    std::vector<const char*> colors_; // Row colors as on screen; nullptr until drawn
+    std::string              frame_;
+    bool                     redraw_;
+};
+
+/*----------------------------------------------------------------------------------------------------*/
+// "HH:MM:SS" of the current UTC time
+std::string utc_clock() {
+    const long long now = (long long)std::time(nullptr);
+    const int seconds = (int)(((now % 86400) + 86400) % 86400);
+    char text[16];
+    std::snprintf(text, sizeof(text), "%02d:%02d:%02d", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    return text;
+}
+
+/*----------------------------------------------------------------------------------------------------*/
+// Shows the newest num_display_days rows and keeps the top one live until Ctrl-C. Every
+// `interval_seconds` the klines from the live row onward are fetched; a newer kline closes the live row
+// and scrolls the table down by one. With live_quotes the top row follows the merged venue price, and the
+// venue tickers are asked at most once per max(quote_ttl, interval_seconds).
+int run_watch(int num_display_days, double interval_seconds, bool live_quotes, double quote_ttl) {
+    std::vector<PiCycleData> rows;
+    LivePiCycle live;
+    int decimals = -1;
+    double factor = 1.0;
+    {
+        KlineStore store;
+        if (!store.open(g_db_path)) return 1;
+        KlineColumns tail = load_price_tail(store.db(), num_display_days + PI_CYCLE_LOOKBACK_ROWS);
+        rows = compute_display_rows(price_series_view(tail), num_display_days);
+        live.reset(price_series_view(tail));
+        decimals = stored_price_decimals(store.db());
+        factor = price_factor(store.db());
+    }
+    if (rows.empty() || decimals < 0) {
+        std::cerr << "No " << g_symbol << " " << g_interval << " klines to watch. Exiting." << std::endl;
+        return 1;
+    }
+
+    CURL* session = curl_easy_init();
+    if (!session) return 1;
+    install_stop_handlers();
+    std::unique_ptr<LiveQuoteFeed> quote_feed;
+    if (live_quotes) quote_feed.reset(new LiveQuoteFeed(g_symbol, std::max(quote_ttl, interval_seconds)));
+
+    char title[128];
+    std::snprintf(title, sizeof(title), "%s %s, refreshing every %.1f s (Ctrl-C to quit)",
+                  g_symbol.c_str(), g_interval.c_str(), interval_seconds);
+    WatchScreen screen(rows.size());
+    screen.draw(rows, rows.size(), title, "Waiting for the first poll...");
+
+    unsigned long long ticks = 0, failures = 0;
+    double draw_us = 0.0;
+    const auto interval = std::chrono::duration<double>(interval_seconds);
+    while (!g_stop_requested) {
+        const auto tick_start = std::chrono::steady_clock::now();
+        std::vector<Kline> klines = get_klines_from_binance(g_symbol, g_interval, decimals, live.open_time(), 0, 1000, session);
+        const double poll_ms = elapsed_ms(tick_start);
+        if (g_stop_requested) break;
+
+        size_t dirty_rows = 0;
+        if (klines.empty()) {
+            ++failures;
+            screen.invalidate(); // The error went to stderr and may have scrolled the table
+        }
+        for (size_t k = 0; k < klines.size(); ++k) {
+            const Kline& kline = klines[k];
+            if (kline.open_time < live.open_time()) continue;
+            if (kline.open_time > live.open_time()) {
+                live.roll(kline.open_time);
+                rows.insert(rows.begin(), live.row());
+                rows.pop_back();
+                dirty_rows = rows.size();
+            }
+            // Closed rows keep their midpoint price; the live row follows the close, as in a normal run
+            live.set_price((k + 1 == klines.size() ? kline.close : kline.price) / factor);
+            rows[0] = live.row();
+            dirty_rows = std::max(dirty_rows, (size_t)1);
+        }
+        char spread[64] = "";
+        if (quote_feed) {
+            // The polled close is fresher than a cached Binance ticker
+            std::vector<VenueQuote> quotes = quote_feed->quotes();
+            if (!klines.empty()) quotes[QUOTE_BINANCE].ticker.last = klines.back().close / factor;
+            const MergedQuote merged = merge_quotes(quotes);
+            if (merged.price > 0) {
+                live.set_price(merged.price);
+                rows[0] = live.row();
+                dirty_rows = std::max(dirty_rows, (size_t)1);
+            }
+            if (merged.venues > 1) {
+                std::snprintf(spread, sizeof(spread), " | %d venues, spread %.3f%%", merged.venues, merged.spread_pct);
+            }
+        }
+        ++ticks;
+
+        char status[256];
+        std::snprintf(status, sizeof(status), "Last poll %s UTC | tick %llu | poll %.0f ms | last redraw %.0f us | %llu failed%s",
+                      utc_clock().c_str(), ticks, poll_ms, draw_us, failures, spread);
+        const auto draw_start = std::chrono::steady_clock::now();
+        screen.draw(rows, dirty_rows, title, status);
+        draw_us = elapsed_ms(draw_start) * 1000.0;
+
+        // Sleep out the rest of the interval in short slices so Ctrl-C is quick
+        while (!g_stop_requested && std::chrono::steady_clock::now() - tick_start < interval) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    curl_easy_cleanup(session);
+    std::cout << "\033[?25h" << COLOR_RESET << std::endl;
+    return 0;
+}